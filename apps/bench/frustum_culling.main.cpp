@@ -0,0 +1,95 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <mov/Bounds.hpp>
+#include <mov/FrustumCuller.hpp>
+
+// Culls spheres scattered around a stereo pair on the CPU and reports the
+// objects tested per microsecond, against one frustum per eye and against
+// the single frustum enclosing both. Needs no GPU.
+
+// Sphere counts to cull; each is culled `iterations` times per setup.
+static const uint32_t objectCounts[] = {1'000, 10'000, 100'000};
+static const uint32_t iterations = 100;
+
+// A typical headset: 64 mm apart, symmetric views about 100 degrees wide.
+static const float eyeSeparation = 0.064f;
+static const float tanHalfFov = 1.2f;
+
+static const float nearDistance = 0.01f;
+static const float farDistance = 1'000;
+
+namespace {
+
+auto eye_frustum(const float x) {
+  const auto projection =
+      glm::frustum(-tanHalfFov * nearDistance, tanHalfFov * nearDistance,
+                   -tanHalfFov * nearDistance, tanHalfFov * nearDistance,
+                   nearDistance, farDistance);
+  const auto view = glm::translate(glm::mat4(1.f), glm::vec3(-x, 0.f, 0.f));
+
+  return mov::Frustum::from_matrix(projection * view);
+}
+
+// Same construction as the app's: the apex moves back until the outer edges
+// of both views pass through it.
+auto combined_frustum() {
+  const auto back = eyeSeparation * 0.5f / tanHalfFov;
+  const auto near = nearDistance + back;
+
+  const auto projection =
+      glm::frustum(-tanHalfFov * near, tanHalfFov * near, -tanHalfFov * near,
+                   tanHalfFov * near, near, farDistance + back);
+  const auto view = glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -back));
+
+  return mov::Frustum::from_matrix(projection * view);
+}
+
+auto run(const std::vector<mov::BoundingSphere> &spheres,
+         const std::vector<mov::Frustum> &frusta) {
+  mov::FrustumCuller culler;
+  for (const auto &sphere : spheres)
+    culler.add(sphere);
+
+  std::vector<uint32_t> visible;
+  for (uint32_t i = 0; i < iterations; i++) {
+    visible.clear();
+    culler.cull(frusta.data(), static_cast<uint32_t>(frusta.size()), visible);
+  }
+
+  return std::tuple{culler.stats(), visible.size()};
+}
+
+} // namespace
+
+int main() {
+  const std::vector per_eye = {eye_frustum(-eyeSeparation * 0.5f),
+                               eye_frustum(eyeSeparation * 0.5f)};
+  const std::vector combined = {combined_frustum()};
+
+  for (const auto object_count : objectCounts) {
+    std::mt19937 random(object_count);
+    std::uniform_real_distribution position(-100.f, 100.f);
+    std::uniform_real_distribution radius(0.1f, 2.f);
+
+    std::vector<mov::BoundingSphere> spheres(object_count);
+    for (auto &sphere : spheres)
+      sphere = {{position(random), position(random), position(random)},
+                radius(random)};
+
+    const auto [eye_stats, eye_visible] = run(spheres, per_eye);
+    const auto [combined_stats, combined_visible] = run(spheres, combined);
+
+    spdlog::info("{} objects: {:.1f} per microsecond against both eyes ({} "
+                 "visible), {:.1f} against the combined frustum ({} visible)",
+                 object_count, eye_stats.objects_per_microsecond(),
+                 eye_visible, combined_stats.objects_per_microsecond(),
+                 combined_visible);
+  }
+}
@@ -0,0 +1,351 @@
+#include <vulkan/vulkan.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <mov/Attachments.hpp>
+#include <mov/GameObject.hpp>
+#include <mov/GeometryPool.hpp>
+#include <mov/HeadlessContext.hpp>
+#include <mov/InstanceBatcher.hpp>
+#include <mov/Mesh.hpp>
+#include <mov/PipelineCache.hpp>
+#include <mov/PipelineVariants.hpp>
+#include <mov/PushConstants.hpp>
+#include <mov/ShaderRegistry.hpp>
+#include <mov/UniformRing.hpp>
+#include <mov/VkAllocator.hpp>
+#include <mov/VkImage.hpp>
+#include <mov/VkUploader.hpp>
+#include <mov/shaders/Shaders.hpp>
+
+// Draws copies of one mesh offscreen, once with a push constant and a draw
+// per object and once through the instance batcher, and compares the draw
+// counts and the time spent recording and executing them. Needs no window
+// or OpenXR runtime, so it runs on any Vulkan device, lavapipe included.
+
+// Copies of the quad, laid out on a square grid.
+static const uint32_t objectCount = 10'000;
+
+// Each path is recorded and executed this many times; times are averaged.
+static const uint32_t iterations = 20;
+
+static const uint32_t width = 512;
+static const uint32_t height = 512;
+
+static const vk::Format colorFormat = vk::Format::eR8G8B8A8Unorm;
+
+// One projection and one view matrix, in the slots of the first eye.
+static const size_t bufferSize = sizeof(glm::mat4) * 2 * 2;
+
+static const std::vector<mov::VertexAttributes> vertices = {
+    {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+    {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+    {{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+    {{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}}};
+
+static const std::vector<uint32_t> indices = {0, 1, 2, 2, 3, 0};
+
+namespace {
+
+struct Timing {
+  std::chrono::nanoseconds record{0};
+  std::chrono::nanoseconds execute{0};
+  uint64_t draws{0};
+
+  [[nodiscard]] auto record_ms() const {
+    return std::chrono::duration<double, std::milli>(record).count() /
+           iterations;
+  }
+
+  [[nodiscard]] auto execute_ms() const {
+    return std::chrono::duration<double, std::milli>(execute).count() /
+           iterations;
+  }
+};
+
+auto create_render_pass(const vk::Device device,
+                        const vk::Format depth_format) {
+  vk::AttachmentDescription attachments[2]{};
+  attachments[0]
+      .setFormat(colorFormat)
+      .setSamples(vk::SampleCountFlagBits::e1)
+      .setLoadOp(vk::AttachmentLoadOp::eClear)
+      .setStoreOp(vk::AttachmentStoreOp::eStore)
+      .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+      .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+      .setInitialLayout(vk::ImageLayout::eUndefined)
+      .setFinalLayout(vk::ImageLayout::eColorAttachmentOptimal);
+  attachments[1]
+      .setFormat(depth_format)
+      .setSamples(vk::SampleCountFlagBits::e1)
+      .setLoadOp(vk::AttachmentLoadOp::eClear)
+      .setStoreOp(vk::AttachmentStoreOp::eDontCare)
+      .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+      .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+      .setInitialLayout(vk::ImageLayout::eUndefined)
+      .setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+  const vk::AttachmentReference color_ref{
+      0, vk::ImageLayout::eColorAttachmentOptimal};
+  const vk::AttachmentReference depth_ref{
+      1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
+
+  vk::SubpassDescription subpass{};
+  subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics)
+      .setColorAttachments(color_ref)
+      .setPDepthStencilAttachment(&depth_ref);
+
+  return device.createRenderPass(vk::RenderPassCreateInfo()
+                                     .setAttachments(attachments)
+                                     .setSubpasses(subpass));
+}
+
+// Same layout as the app's: per-eye matrices and the instance buffer.
+auto create_descriptor_set_layout(const vk::Device device) {
+  vk::DescriptorSetLayoutBinding bindings[2]{};
+  bindings[0]
+      .setBinding(0)
+      .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
+      .setDescriptorCount(1)
+      .setStageFlags(vk::ShaderStageFlagBits::eVertex);
+  bindings[1]
+      .setBinding(1)
+      .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+      .setDescriptorCount(1)
+      .setStageFlags(vk::ShaderStageFlagBits::eVertex);
+
+  return device.createDescriptorSetLayout(
+      vk::DescriptorSetLayoutCreateInfo().setBindings(bindings));
+}
+
+auto create_descriptor_set(const vk::Device device,
+                           const vk::DescriptorPool descriptor_pool,
+                           const vk::DescriptorSetLayout layout,
+                           const vk::Buffer uniform_buffer,
+                           const vk::Buffer instance_buffer) {
+  const auto descriptor_set =
+      device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo()
+                                        .setDescriptorPool(descriptor_pool)
+                                        .setSetLayouts(layout))[0];
+
+  const vk::DescriptorBufferInfo uniform_info{uniform_buffer, 0, bufferSize};
+  const vk::DescriptorBufferInfo instance_info{instance_buffer, 0,
+                                               VK_WHOLE_SIZE};
+
+  vk::WriteDescriptorSet writes[2]{};
+  writes[0]
+      .setDstSet(descriptor_set)
+      .setDstBinding(0)
+      .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
+      .setBufferInfo(uniform_info);
+  writes[1]
+      .setDstSet(descriptor_set)
+      .setDstBinding(1)
+      .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+      .setBufferInfo(instance_info);
+
+  device.updateDescriptorSets(writes, nullptr);
+
+  return descriptor_set;
+}
+
+} // namespace
+
+int main() {
+  mov::HeadlessContext context;
+  const auto device = context.device();
+  const auto physical_device = context.physical_device();
+
+  spdlog::info("Device: {}", physical_device.getProperties().deviceName.data());
+
+  mov::VkAllocator allocator(device, physical_device);
+  mov::VkUploader uploader(allocator, context.queue_family(), context.queue());
+  mov::GeometryPool geometry(mov::VkBufferProvider(allocator, uploader));
+  mov::UniformRing uniforms(allocator, 1);
+  mov::InstanceBatcher instances(allocator, 1, objectCount);
+
+  const auto depth_format =
+      mov::find_depth_format(physical_device, 0.1f, 100.f);
+  const auto render_pass = create_render_pass(device, depth_format);
+
+  mov::VkImage color(allocator, width, height, colorFormat,
+                     vk::ImageTiling::eOptimal,
+                     vk::ImageAspectFlagBits::eColor,
+                     vk::ImageUsageFlagBits::eColorAttachment,
+                     vk::MemoryPropertyFlagBits::eDeviceLocal,
+                     mov::MemoryCategory::Attachments);
+  mov::VkImage depth(allocator, width, height, depth_format,
+                     vk::ImageTiling::eOptimal,
+                     vk::ImageAspectFlagBits::eDepth,
+                     vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                     vk::MemoryPropertyFlagBits::eDeviceLocal,
+                     mov::MemoryCategory::Attachments);
+
+  const vk::ImageView attachments[] = {color.image_view, depth.image_view};
+  const auto framebuffer = device.createFramebuffer(
+      vk::FramebufferCreateInfo()
+          .setRenderPass(render_pass)
+          .setAttachments(attachments)
+          .setWidth(width)
+          .setHeight(height)
+          .setLayers(1));
+
+  const vk::DescriptorPoolSize pool_sizes[] = {
+      {vk::DescriptorType::eUniformBufferDynamic, 1},
+      {vk::DescriptorType::eStorageBuffer, 1}};
+  const auto descriptor_pool = device.createDescriptorPool(
+      vk::DescriptorPoolCreateInfo().setMaxSets(1).setPoolSizes(pool_sizes));
+  const auto descriptor_set_layout = create_descriptor_set_layout(device);
+  const auto descriptor_set =
+      create_descriptor_set(device, descriptor_pool, descriptor_set_layout,
+                            uniforms.buffer(), instances.buffer());
+
+  const auto pipeline_layout = device.createPipelineLayout(
+      vk::PipelineLayoutCreateInfo()
+          .setSetLayouts(descriptor_set_layout)
+          .setPushConstantRanges(vk::PushConstantRange(
+              vk::ShaderStageFlagBits::eVertex, 0,
+              sizeof(mov::PushConstants))));
+
+  // Nothing is saved, so the cache file is never created.
+  mov::PipelineCache pipeline_cache(
+      device, physical_device,
+      std::filesystem::temp_directory_path() / "mov.bench.cache", false);
+  mov::ShaderRegistry shader_registry(mov::shaders::all);
+  mov::PipelineVariants pipelines(device, pipeline_cache, shader_registry);
+
+  const mov::PipelineKey pipeline_key{render_pass, pipeline_layout, 1,
+                                      mov::VertexFormat::Float};
+  auto instanced_key = pipeline_key;
+  instanced_key.instanced = true;
+
+  const auto pipeline = pipelines.get(pipeline_key);
+  const auto instanced_pipeline = pipelines.get(instanced_key);
+
+  const auto quad =
+      mov::Mesh(geometry, vertices, indices, mov::VertexFormat::Float);
+  uploader.flush();
+  uploader.wait_idle();
+
+  const auto columns = static_cast<uint32_t>(
+      glm::ceil(glm::sqrt(static_cast<float>(objectCount))));
+
+  std::vector<mov::GameObject> objects;
+  objects.reserve(objectCount);
+  for (uint32_t i = 0; i < objectCount; i++) {
+    auto &object = objects.emplace_back(quad);
+    object.transform.move_abs(glm::vec3(static_cast<float>(i % columns),
+                                        static_cast<float>(i / columns), 0.f));
+  }
+
+  // Every object covers a few pixels, so neither path is fill bound.
+  uniforms.begin_frame(0);
+  const auto [matrices, uniform_offset] = uniforms.allocate(bufferSize);
+  const auto extent = static_cast<float>(columns);
+  const glm::mat4 projection_view[] = {
+      glm::ortho(-1.f, extent, -1.f, extent, -1.f, 1.f), glm::mat4(1.f)};
+  std::memcpy(static_cast<std::byte *>(matrices), &projection_view[0],
+              sizeof(glm::mat4));
+  std::memcpy(static_cast<std::byte *>(matrices) + sizeof(glm::mat4) * 2,
+              &projection_view[1], sizeof(glm::mat4));
+
+  const vk::ClearValue clear_values[] = {
+      vk::ClearColorValue(std::array{0.f, 0.f, 0.f, 1.f}),
+      vk::ClearDepthStencilValue(1.f, 0)};
+
+  const auto run = [&](const vk::Pipeline bound_pipeline, auto &&draw) {
+    Timing timing;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+      const auto start = std::chrono::steady_clock::now();
+      auto recorded = start;
+
+      context.submit([&](const vk::CommandBuffer commands) {
+        commands.beginRenderPass(
+            vk::RenderPassBeginInfo()
+                .setRenderPass(render_pass)
+                .setFramebuffer(framebuffer)
+                .setRenderArea({{0, 0}, {width, height}})
+                .setClearValues(clear_values),
+            vk::SubpassContents::eInline);
+
+        commands.setViewport(
+            0, vk::Viewport(0.f, 0.f, static_cast<float>(width),
+                            static_cast<float>(height), 0.f, 1.f));
+        commands.setScissor(0, vk::Rect2D({0, 0}, {width, height}));
+        commands.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                              bound_pipeline);
+        commands.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                    pipeline_layout, 0, descriptor_set,
+                                    uniform_offset);
+        geometry.bind(commands);
+
+        timing.draws += draw(commands);
+
+        commands.endRenderPass();
+        recorded = std::chrono::steady_clock::now();
+      });
+
+      const auto end = std::chrono::steady_clock::now();
+      timing.record += recorded - start;
+      timing.execute += end - recorded;
+    }
+
+    timing.draws /= iterations;
+    return timing;
+  };
+
+  const auto push_constants =
+      run(pipeline, [&](const vk::CommandBuffer commands) {
+        for (auto &object : objects)
+          object.draw(commands, pipeline_layout);
+
+        return static_cast<uint64_t>(objects.size());
+      });
+
+  const auto instanced =
+      run(instanced_pipeline, [&](const vk::CommandBuffer commands) {
+        const auto before = instances.stats().draws;
+
+        instances.begin_frame(0);
+        for (auto &object : objects)
+          object.batch(instances);
+        instances.draw(commands);
+
+        return instances.stats().draws - before;
+      });
+
+  spdlog::info("{} objects, {} iterations", objectCount, iterations);
+  spdlog::info("Push constants: {} draws, {:.3f} ms recording, {:.3f} ms "
+               "submitting and executing",
+               push_constants.draws, push_constants.record_ms(),
+               push_constants.execute_ms());
+  spdlog::info("Instanced: {} draws, {:.3f} ms recording, {:.3f} ms "
+               "submitting and executing",
+               instanced.draws, instanced.record_ms(), instanced.execute_ms());
+
+  device.destroyFramebuffer(framebuffer);
+  color.destroy();
+  depth.destroy();
+  device.destroyRenderPass(render_pass);
+  device.destroyPipelineLayout(pipeline_layout);
+  device.destroyDescriptorSetLayout(descriptor_set_layout);
+  device.destroyDescriptorPool(descriptor_pool);
+  pipelines.destroy();
+  pipeline_cache.destroy();
+  quad.destroy();
+  instances.destroy();
+  uniforms.destroy();
+  geometry.destroy();
+  uploader.destroy();
+  allocator.destroy();
+  context.destroy();
+}
@@ -0,0 +1,53 @@
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <string>
+
+#include <spdlog/spdlog.h>
+
+#include <mov/MeshOptimizer.hpp>
+
+#include "core/MeshImport.hpp"
+
+// Logs the simulated vertex cache efficiency of every mesh in each model
+// given on the command line, before and after optimization, and whether its
+// indices fit in 16 bits. Needs no GPU.
+int main(const int argc, const char *const argv[]) {
+  if (argc < 2) {
+    spdlog::error("Usage: {} <model.obj>...", argv[0]);
+    return 1;
+  }
+
+  int failures = 0;
+
+  for (int arg = 1; arg < argc; arg++) {
+    const std::string path = argv[arg];
+    Assimp::Importer importer;
+
+    const auto scene = importer.ReadFile(path, mov::core::importFlags);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) {
+      spdlog::error("Failed to load model {}: {}", path,
+                    importer.GetErrorString());
+      failures++;
+      continue;
+    }
+
+    for (auto i = 0u; i < scene->mNumMeshes; ++i) {
+      auto [vertices, indices] = mov::core::import_mesh(scene->mMeshes[i]);
+
+      const auto before = mov::analyze_vertex_cache(
+          indices, static_cast<uint32_t>(vertices.size()));
+      mov::optimize_mesh(indices, vertices);
+      const auto after = mov::analyze_vertex_cache(
+          indices, static_cast<uint32_t>(vertices.size()));
+
+      spdlog::info("{} mesh {}: {} triangles, {} vertices, ACMR {:.3f} -> "
+                   "{:.3f}, ATVR {:.3f} -> {:.3f}, 16-bit indices {}",
+                   path, i, after.triangles, vertices.size(), before.acmr(),
+                   after.acmr(), before.atvr(), after.atvr(),
+                   mov::to_16bit_indices(indices) ? "fit" : "do not fit");
+    }
+  }
+
+  return failures;
+}
@@ -16,20 +16,47 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
 #include <csignal>
-#include <fstream>
+#include <cstdlib>
 #include <iostream>
 #include <map>
 #include <set>
+#include <string_view>
 
 #include <spdlog/spdlog.h>
 
+#include <mov/Attachments.hpp>
+#include <mov/CommandCache.hpp>
+#include <mov/DynamicResolution.hpp>
+#include <mov/FrameScheduler.hpp>
+#include <mov/FrustumCuller.hpp>
 #include <mov/GameObject.hpp>
+#include <mov/GeometryPool.hpp>
+#include <mov/GpuCuller.hpp>
+#include <mov/GpuProfiler.hpp>
+#include <mov/InstanceBatcher.hpp>
+#include <mov/LodChain.hpp>
+#include <mov/MemoryBudget.hpp>
 #include <mov/Mesh.hpp>
+#include <mov/MeshOptimizer.hpp>
+#include <mov/MeshSimplifier.hpp>
+#include <mov/Meshlets.hpp>
+#include <mov/ParallelRecorder.hpp>
+#include <mov/PipelineCache.hpp>
+#include <mov/PipelineVariants.hpp>
+#include <mov/ShaderRegistry.hpp>
+#include <mov/Tracer.hpp>
+#include <mov/UniformRing.hpp>
+#include <mov/VkAllocator.hpp>
 #include <mov/VkBuffer.hpp>
 #include <mov/VkImage.hpp>
+#include <mov/VkUploader.hpp>
+#include <mov/VkUtils.hpp>
+#include <mov/shaders/Shaders.hpp>
 
 #include "core/Controller.hpp"
+#include "core/MeshImport.hpp"
 
 const std::map<XrDebugUtilsMessageTypeFlagsEXT, std::string> xrMessageTypeMap =
     {
@@ -75,9 +102,96 @@ static const char *const extensionNames[] = {
 static const char *const vulkanLayerNames[] = {"VK_LAYER_KHRONOS_validation"};
 static const char *const vulkanExtensionNames[] = {"VK_EXT_debug_utils"};
 
-static const size_t bufferSize = sizeof(float) * 4 * 4 * 2;
-
 static const size_t eyeCount = 2;
+static const uint32_t framesInFlight = 2;
+
+// A projection and a view matrix per eye.
+static const size_t bufferSize = sizeof(float) * 4 * 4 * 2 * eyeCount;
+
+// Render both eyes in one pass when the device supports multiview, instead
+// of one pass per eye.
+static const bool preferMultiview = true;
+
+// Copies of the quad drawn through the instanced path, to compare draw call
+// counts against one push-constant draw per object. MOV_CROWD_SIZE overrides
+// it at runtime, up to the GPU culler's capacity; 0 disables them.
+static const uint32_t defaultCrowdSize = 1'000;
+
+// Record the GPU culled crowd's indirect draws once per framebuffer and
+// replay them until the pipeline, the attachments or the number of culled
+// objects change. Everything else they depend on is read from buffers the
+// cull pass rewrites every frame. Push-constant draws are never cached, as
+// they bake in matrices, levels of detail and geometry pool offsets that
+// LOD selection and defragmentation change behind the cache's back.
+static const bool cacheStaticCommands = true;
+
+// Draw the crowd instanced through the batcher when it is not culled on the
+// GPU; otherwise every visible member is its own push-constant draw, which
+// is what the parallel recorder spreads across threads.
+static const bool batchCrowd = true;
+
+// Frustum cull the crowd in a compute pass and draw the survivors with
+// indirect draws, instead of drawing every member through the batcher.
+static const bool gpuCulling = true;
+
+static const bool cacheCrowd = cacheStaticCommands && gpuCulling;
+
+// Read the culling results back every frame and check them against the same
+// test on the CPU. Stalls the queue; for debugging only.
+static const bool verifyGpuCulling = false;
+
+// Compiled pipelines are kept here between runs, so relaunching the app does
+// not compile every pipeline again.
+static const char *const pipelineCachePath = "pipeline.cache";
+
+// Meshes are stored with quantized positions and packed normals, colors and
+// uvs, cutting vertex fetch bandwidth; Float keeps 32-bit floats.
+static const mov::VertexFormat vertexFormat = mov::VertexFormat::Packed;
+
+// Reorder imported triangles and vertices for the post-transform cache,
+// overdraw and vertex fetch before uploading them.
+static const bool optimizeMeshes = true;
+
+// Simplify every imported mesh into a chain of levels of detail, and draw
+// the coarsest one whose error would cover at most lodPixelError pixels.
+static const bool generateLods = true;
+static const mov::LodSettings lodSettings{};
+static const float lodPixelError = 1.f;
+
+// Split imported meshes into meshlets and cull those in a compute pass, so
+// parts of a model off screen or facing away skip the vertex stage. Only
+// needs indirect draws, not mesh shaders.
+static const bool meshletCulling = true;
+
+// Also drop meshlets facing away from both eyes. Mesh pipelines draw both
+// sides of every triangle, so this leaves holes wherever the back of a
+// model shows: through open or single layered parts, or from inside it.
+// Only turn it on for scenes of closed models.
+static const bool meshletConeCulling = false;
+
+// Store the indices of meshes drawn with push constants or instanced as 16
+// bits when every vertex index fits, halving their index fetch. Meshes the
+// GPU culls keep 32-bit indices, as all indirect draws share one binding.
+static const bool compactIndices = true;
+
+// Render each eye to a part of its swapchain image sized from the GPU time
+// of recent frames, to hold the frame rate through load spikes. Needs
+// timestamp queries on the graphics queue.
+static const bool dynamicResolution = true;
+static const mov::DynamicResolutionSettings dynamicResolutionSettings{};
+
+// Time the cull pass, each render pass and the draw batches inside them with
+// timestamp queries, and label them for frame captures.
+static const bool gpuProfiling = true;
+
+// Where the CPU trace goes, in the Chrome trace format. It is written on
+// exit and whenever the process gets SIGUSR1 (Ctrl+Break on Windows) when
+// built with MOV_TRACING.
+static const char *traceFile = "core.trace.json";
+static const bool writeTraceOnExit = true;
+
+// Upper bound on geometry the defragmenter may move in a single frame.
+static const vk::DeviceSize defragmentBudget = 1024 * 1024;
 
 static const float nearDistance = 0.01f;
 static const float farDistance = 1'000;
@@ -94,14 +208,54 @@ static XrQuaternionf right_hand_orientation{0, 0, 0, 1};
 
 static mov::GameObject object;
 static mov::core::Controller controller;
+static std::vector<mov::GameObject> crowd;
+
+// Bumped whenever the crowd changes, to invalidate cached recordings of it.
+static uint64_t crowdVersion = 0;
+
+auto crowd_size() {
+  const auto *const value = std::getenv("MOV_CROWD_SIZE");
+  if (!value)
+    return defaultCrowdSize;
+
+  return static_cast<uint32_t>(std::min<unsigned long>(
+      std::strtoul(value, nullptr, 10),
+      mov::GpuCuller::default_frame_capacity));
+}
+
+// Shaders are built into the binary. Point MOV_SHADER_DIR at the build's
+// data directory to load any <name>.spv found there instead, to iterate on
+// shaders without relinking; unset uses the built-in ones only.
+auto shader_override_directory() -> std::string {
+  const auto *const value = std::getenv("MOV_SHADER_DIR");
+  return value ? value : "";
+}
 
 void onInterrupt(int) { quit = true; }
 
+static volatile std::sig_atomic_t traceRequested = 0;
+
+void onTraceRequest(int) { traceRequested = 1; }
+
+void write_trace() {
+  if constexpr (!mov::tracing_enabled)
+    return;
+
+  try {
+    auto &tracer = mov::Tracer::get();
+    const auto events = tracer.write_chrome_trace(traceFile);
+    spdlog::info("Wrote {} trace events to {}, {} older ones overwritten",
+                 events, traceFile, tracer.stats().overwritten);
+  } catch (const std::runtime_error &error) {
+    spdlog::error("Failed to write the CPU trace: {}", error.what());
+  }
+}
+
 struct PushConstants {
   glm::mat4 model;
 };
 
-const std::vector<mov::Vertex> vertices = {
+const std::vector<mov::VertexAttributes> vertices = {
     {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
     {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
     {{0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}},
@@ -111,8 +265,9 @@ const std::vector<uint32_t> indices = {0, 1, 2, 2, 3, 0};
 
 struct Swapchain {
   Swapchain(xr::Swapchain swapchain, vk::Format format, uint32_t width,
-            uint32_t height)
-      : swapchain(swapchain), format(format), width(width), height(height) {}
+            uint32_t height, uint32_t layers = 1)
+      : swapchain(swapchain), format(format), width(width), height(height),
+        layers(layers) {}
 
   ~Swapchain() { swapchain.destroy(); }
 
@@ -120,170 +275,57 @@ struct Swapchain {
   vk::Format format;
   uint32_t width;
   uint32_t height;
+  uint32_t layers;
 };
 
-auto find_supported_format(const vk::PhysicalDevice physical_device,
-                           const std::vector<vk::Format> &candidates,
-                           const vk::ImageTiling tiling,
-                           const vk::FormatFeatureFlags features) {
-  for (const auto &format : candidates) {
-    auto props = physical_device.getFormatProperties(format);
-
-    if (tiling == vk::ImageTiling::eLinear &&
-        (props.linearTilingFeatures & features) == features)
-      return format;
-    if (tiling == vk::ImageTiling::eOptimal &&
-        (props.optimalTilingFeatures & features) == features)
-      return format;
-  }
-
-  throw std::runtime_error("failed to find supported format!");
-}
-
-auto find_depth_format(const vk::PhysicalDevice physical_device) -> vk::Format {
-  return find_supported_format(
-      physical_device,
-      {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint,
-       vk::Format::eD24UnormS8Uint},
-      vk::ImageTiling::eOptimal,
-      vk::FormatFeatureFlagBits::eDepthStencilAttachment);
-}
-
 struct SwapchainImage {
-  SwapchainImage(vk::PhysicalDevice physical_device, vk::Device device,
-                 vk::RenderPass render_pass, vk::CommandPool command_pool,
-                 vk::DescriptorPool descriptor_pool,
-                 vk::DescriptorSetLayout descriptor_set_layout,
-                 const Swapchain *swapchain, xr::SwapchainImageVulkanKHR image)
-      : image(image), device(device), commandPool(command_pool),
-        descriptorPool(descriptor_pool) {
+  SwapchainImage(vk::Device device, vk::RenderPass render_pass,
+                 const Swapchain *swapchain, xr::SwapchainImageVulkanKHR image,
+                 const mov::TransientAttachments &depth_targets)
+      : image(image), device(device) {
     vk::ImageViewCreateInfo image_view_create_info{};
     image_view_create_info.setImage(image.image)
-        .setViewType(vk::ImageViewType::e2D)
+        .setViewType(swapchain->layers > 1 ? vk::ImageViewType::e2DArray
+                                           : vk::ImageViewType::e2D)
         .setFormat(swapchain->format)
         .setSubresourceRange(vk::ImageSubresourceRange()
                                  .setAspectMask(vk::ImageAspectFlagBits::eColor)
                                  .setBaseMipLevel(0)
                                  .setLevelCount(1)
                                  .setBaseArrayLayer(0)
-                                 .setLayerCount(1));
+                                 .setLayerCount(swapchain->layers));
 
     imageView = device.createImageView(image_view_create_info);
-    depthImage =
-        mov::VkImage(device, physical_device, swapchain->width,
-                     swapchain->height, find_depth_format(physical_device),
-                     vk::ImageTiling::eOptimal, vk::ImageAspectFlagBits::eDepth,
-                     vk::ImageUsageFlagBits::eDepthStencilAttachment,
-                     vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-    vk::ImageView imageViews[2] = {imageView, depthImage.image_view};
-
-    vk::FramebufferCreateInfo framebuffer_create_info{};
-    framebuffer_create_info.setRenderPass(render_pass)
-        .setAttachments(imageViews)
-        .setWidth(swapchain->width)
-        .setHeight(swapchain->height)
-        .setLayers(1);
-
-    framebuffer = device.createFramebuffer(framebuffer_create_info);
-
-    vk::BufferCreateInfo create_info{};
-    create_info.setSize(bufferSize)
-        .setUsage(vk::BufferUsageFlagBits::eUniformBuffer)
-        .setSharingMode(vk::SharingMode::eExclusive);
-
-    buffer = device.createBuffer(create_info);
 
-    vk::MemoryRequirements requirements =
-        device.getBufferMemoryRequirements(buffer);
+    // Depth is shared per frame in flight, so each slot needs its own
+    // framebuffer around this color image.
+    for (uint32_t slot = 0; slot < framesInFlight; slot++) {
+      vk::ImageView imageViews[2] = {imageView,
+                                     depth_targets[slot].image_view};
 
-    vk::MemoryPropertyFlags flags = vk::MemoryPropertyFlagBits::eHostVisible |
-                                    vk::MemoryPropertyFlagBits::eHostCoherent;
+      vk::FramebufferCreateInfo framebuffer_create_info{};
+      framebuffer_create_info.setRenderPass(render_pass)
+          .setAttachments(imageViews)
+          .setWidth(swapchain->width)
+          .setHeight(swapchain->height)
+          .setLayers(1);
 
-    vk::PhysicalDeviceMemoryProperties properties =
-        physical_device.getMemoryProperties();
-
-    uint32_t memory_type_index = 0;
-
-    for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
-      if (!(requirements.memoryTypeBits & (1 << i))) {
-        continue;
-      }
-
-      if ((properties.memoryTypes[i].propertyFlags & flags) != flags) {
-        continue;
-      }
-
-      memory_type_index = i;
-      break;
+      framebuffers[slot] = device.createFramebuffer(framebuffer_create_info);
     }
-
-    VkMemoryAllocateInfo allocateInfo{};
-    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocateInfo.allocationSize = requirements.size;
-    allocateInfo.memoryTypeIndex = memory_type_index;
-
-    vk::MemoryAllocateInfo allocate_info{};
-    allocate_info.setAllocationSize(requirements.size)
-        .setMemoryTypeIndex(memory_type_index);
-
-    memory = device.allocateMemory(allocate_info);
-
-    device.bindBufferMemory(buffer, memory, 0);
-
-    vk::CommandBufferAllocateInfo command_buffer_allocate_info{};
-    command_buffer_allocate_info.setCommandPool(command_pool)
-        .setLevel(vk::CommandBufferLevel::ePrimary)
-        .setCommandBufferCount(1);
-
-    commandBuffer =
-        device.allocateCommandBuffers(command_buffer_allocate_info)[0];
-
-    vk::DescriptorSetAllocateInfo descriptor_set_allocate_info{};
-    descriptor_set_allocate_info.setDescriptorPool(descriptor_pool)
-        .setSetLayouts(descriptor_set_layout);
-
-    descriptorSet =
-        device.allocateDescriptorSets(descriptor_set_allocate_info)[0];
-
-    vk::DescriptorBufferInfo descriptor_buffer_info{};
-    descriptor_buffer_info.setBuffer(buffer).setOffset(0).setRange(~0);
-
-    vk::WriteDescriptorSet descriptor_write{};
-    descriptor_write.setDstSet(descriptorSet)
-        .setDstBinding(0)
-        .setDstArrayElement(0)
-        .setDescriptorCount(1)
-        .setDescriptorType(vk::DescriptorType::eUniformBuffer)
-        .setPBufferInfo(&descriptor_buffer_info);
-
-    device.updateDescriptorSets(1, &descriptor_write, 0, nullptr);
   }
 
   ~SwapchainImage() {
-    device.freeDescriptorSets(descriptorPool, 1, &descriptorSet);
-    device.freeCommandBuffers(commandPool, 1, &commandBuffer);
-    device.destroyBuffer(buffer);
-    device.freeMemory(memory);
-    device.destroyFramebuffer(framebuffer);
+    for (const auto framebuffer : framebuffers)
+      device.destroyFramebuffer(framebuffer);
     device.destroyImageView(imageView);
-    depthImage.destroy();
   }
 
   xr::SwapchainImageVulkanKHR image;
   vk::ImageView imageView;
-  vk::Framebuffer framebuffer;
-  vk::DeviceMemory memory;
-  vk::Buffer buffer;
-  vk::CommandBuffer commandBuffer;
-  vk::DescriptorSet descriptorSet;
-
-  mov::VkImage depthImage;
+  vk::Framebuffer framebuffers[framesInFlight];
 
 private:
   vk::Device device;
-  vk::CommandPool commandPool;
-  vk::DescriptorPool descriptorPool;
 };
 
 auto create_instance() {
@@ -497,31 +539,92 @@ auto destroy_vulkan_debug_messenger(
   instance.destroyDebugUtilsMessengerEXT(debug_messenger);
 }
 
-auto get_device_queue_family(const vk::PhysicalDevice physical_device) {
-  uint32_t graphics_queue_family_index = -1;
+auto get_device_queue_families(const vk::PhysicalDevice physical_device) {
+  const auto families = mov::find_queue_families(physical_device);
 
-  const std::vector<vk::QueueFamilyProperties> queue_families =
-      physical_device.getQueueFamilyProperties();
+  spdlog::info("Queue families: graphics {}, transfer {}{}, compute {}{}",
+               families.graphics, families.transfer,
+               families.has_dedicated_transfer() ? " (dedicated)" : "",
+               families.compute,
+               families.has_async_compute() ? " (async)" : "");
 
-  for (uint32_t i = 0; i < queue_families.size(); i++) {
-    if (queue_families[i].queueFlags & vk::QueueFlagBits::eGraphics) {
-      graphics_queue_family_index = i;
-      break;
-    }
-  }
+  return families;
+}
 
-  if (graphics_queue_family_index == -1) {
-    spdlog::error("No graphics queue found.");
-    return graphics_queue_family_index;
-  }
+// VK_EXT_memory_budget is queried through vkGetPhysicalDeviceMemoryProperties2,
+// so both the instance and the device need to be at least Vulkan 1.1.
+auto supports_memory_budget(const vk::PhysicalDevice physical_device,
+                            const uint32_t instance_api_version) {
+  if (instance_api_version < VK_API_VERSION_1_1 ||
+      physical_device.getProperties().apiVersion < VK_API_VERSION_1_1)
+    return false;
+
+  const auto extensions = physical_device.enumerateDeviceExtensionProperties();
+
+  return std::ranges::any_of(extensions, [](const auto &extension) {
+    return std::string_view(extension.extensionName) ==
+           VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+  });
+}
+
+// Multiview is core in Vulkan 1.1 and its feature bit is queried through
+// vkGetPhysicalDeviceFeatures2.
+auto supports_multiview(const vk::PhysicalDevice physical_device,
+                        const uint32_t instance_api_version) {
+  if (instance_api_version < VK_API_VERSION_1_1 ||
+      physical_device.getProperties().apiVersion < VK_API_VERSION_1_1)
+    return false;
+
+  const auto features =
+      physical_device.getFeatures2<vk::PhysicalDeviceFeatures2,
+                                   vk::PhysicalDeviceMultiviewFeatures>();
+  const auto properties =
+      physical_device.getProperties2<vk::PhysicalDeviceProperties2,
+                                     vk::PhysicalDeviceMultiviewProperties>();
+
+  return features.get<vk::PhysicalDeviceMultiviewFeatures>().multiview &&
+         properties.get<vk::PhysicalDeviceMultiviewProperties>()
+                 .maxMultiviewViewCount >= eyeCount;
+}
+
+// drawIndirectCount is core in Vulkan 1.2 and, like multiview, only exposed
+// through vkGetPhysicalDeviceFeatures2.
+auto supports_draw_indirect_count(const vk::PhysicalDevice physical_device,
+                                  const uint32_t instance_api_version) {
+  if (instance_api_version < VK_API_VERSION_1_2 ||
+      physical_device.getProperties().apiVersion < VK_API_VERSION_1_2)
+    return false;
+
+  const auto features =
+      physical_device.getFeatures2<vk::PhysicalDeviceFeatures2,
+                                   vk::PhysicalDeviceVulkan12Features>();
+
+  return features.get<vk::PhysicalDeviceVulkan12Features>()
+             .drawIndirectCount == VK_TRUE;
+}
+
+// Tells whether a pipeline was found in the cache, so hits can be reported.
+auto supports_pipeline_creation_feedback(
+    const vk::PhysicalDevice physical_device) {
+  const auto extensions = physical_device.enumerateDeviceExtensionProperties();
 
-  return graphics_queue_family_index;
+  return std::ranges::any_of(extensions, [](const auto &extension) {
+    return std::string_view(extension.extensionName) ==
+           VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME;
+  });
 }
 
+struct DeviceFeatures {
+  bool multiview{false};
+  bool draw_indirect_count{false};
+  bool multi_draw_indirect{false};
+};
+
 auto create_device(const vk::PhysicalDevice physical_device,
-                   const uint32_t graphics_queue_family_index,
-                   const std::set<std::string> &device_extensions)
-    -> std::tuple<vk::Device, vk::Queue> {
+                   const mov::QueueFamilies &queue_families,
+                   const std::set<std::string> &device_extensions,
+                   const DeviceFeatures &features)
+    -> std::tuple<vk::Device, vk::Queue, vk::Queue, vk::Queue> {
   std::vector<const char *> extensions;
   extensions.reserve(device_extensions.size());
   std::ranges::transform(device_extensions, std::back_inserter(extensions),
@@ -529,26 +632,49 @@ auto create_device(const vk::PhysicalDevice physical_device,
 
   float priority = 1;
 
-  vk::DeviceQueueCreateInfo queue_create_info{
-      vk::DeviceQueueCreateFlags{}, graphics_queue_family_index, 1, &priority};
+  const std::set<uint32_t> unique_families{
+      queue_families.graphics, queue_families.transfer, queue_families.compute};
+
+  std::vector<vk::DeviceQueueCreateInfo> queue_create_infos;
+  for (const auto family : unique_families)
+    queue_create_infos.emplace_back(vk::DeviceQueueCreateFlags{}, family, 1,
+                                    &priority);
 
   vk::PhysicalDeviceFeatures physical_features{};
-  physical_features.setSamplerAnisotropy(true);
+  physical_features.setSamplerAnisotropy(true).setMultiDrawIndirect(
+      features.multi_draw_indirect);
+
+  void *next = nullptr;
+
+  vk::PhysicalDeviceVulkan12Features vulkan12_features{};
+  if (features.draw_indirect_count) {
+    vulkan12_features.setDrawIndirectCount(true).setPNext(next);
+    next = &vulkan12_features;
+  }
+
+  vk::PhysicalDeviceMultiviewFeatures multiview_features{};
+  if (features.multiview) {
+    multiview_features.setMultiview(true).setPNext(next);
+    next = &multiview_features;
+  }
 
   vk::DeviceCreateInfo create_info{};
-  create_info.setQueueCreateInfos(queue_create_info)
+  create_info.setQueueCreateInfos(queue_create_infos)
       .setPEnabledExtensionNames(extensions)
-      .setPEnabledFeatures(&physical_features);
+      .setPEnabledFeatures(&physical_features)
+      .setPNext(next);
 
   auto device = physical_device.createDevice(create_info);
 
-  auto queue = device.getQueue(graphics_queue_family_index, 0);
-
-  return {device, queue};
+  return {device, device.getQueue(queue_families.graphics, 0),
+          device.getQueue(queue_families.transfer, 0),
+          device.getQueue(queue_families.compute, 0)};
 }
 
-auto create_render_pass(const vk::Device device,
-                        const vk::PhysicalDevice physical_device) {
+// With view_count > 1 every attachment is a layered image and the subpass
+// broadcasts to all layers through multiview.
+auto create_render_pass(const vk::Device device, const vk::Format depth_format,
+                        const uint32_t view_count) {
   vk::AttachmentDescription attachment{};
   attachment.setFormat(vk::Format::eR8G8B8A8Srgb)
       .setSamples(vk::SampleCountFlagBits::e1)
@@ -564,10 +690,10 @@ auto create_render_pass(const vk::Device device,
       vk::ImageLayout::eColorAttachmentOptimal);
 
   vk::AttachmentDescription depth_attachment{};
-  depth_attachment.setFormat(find_depth_format(physical_device))
+  depth_attachment.setFormat(depth_format)
       .setSamples(vk::SampleCountFlagBits::e1)
       .setLoadOp(vk::AttachmentLoadOp::eClear)
-      .setStoreOp(vk::AttachmentStoreOp::eStore)
+      .setStoreOp(vk::AttachmentStoreOp::eDontCare)
       .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
       .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
       .setInitialLayout(vk::ImageLayout::eUndefined)
@@ -595,7 +721,7 @@ auto create_render_pass(const vk::Device device,
       .setDstSubpass(0)
       .setSrcStageMask(vk::PipelineStageFlagBits::eEarlyFragmentTests |
                        vk::PipelineStageFlagBits::eLateFragmentTests)
-      .setSrcAccessMask(vk::AccessFlagBits::eNone)
+      .setSrcAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentWrite)
       .setDstStageMask(vk::PipelineStageFlagBits::eEarlyFragmentTests |
                        vk::PipelineStageFlagBits::eLateFragmentTests)
       .setDstAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentWrite);
@@ -603,66 +729,98 @@ auto create_render_pass(const vk::Device device,
   vk::AttachmentDescription attachments[2] = {attachment, depth_attachment};
   vk::SubpassDependency dependencies[2] = {dependency, depth_dependency};
 
+  const uint32_t view_mask = (1u << view_count) - 1;
+
+  vk::RenderPassMultiviewCreateInfo multiview_info{};
+  multiview_info.setViewMasks(view_mask).setCorrelationMasks(view_mask);
+
   vk::RenderPassCreateInfo create_info{};
   create_info.setAttachments(attachments)
       .setSubpasses(subpass)
-      .setDependencies(dependencies);
+      .setDependencies(dependencies)
+      .setPNext(view_count > 1 ? &multiview_info : nullptr);
 
   return device.createRenderPass(create_info, nullptr);
 }
 
-auto create_command_pool(const vk::Device device,
-                         const uint32_t graphics_queue_family_index) {
-  return device.createCommandPool(
-      {vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-       graphics_queue_family_index});
-}
-
 auto create_descriptor_pool(const vk::Device device) {
-  vk::DescriptorPoolSize pool_size{};
-  pool_size.setType(vk::DescriptorType::eUniformBuffer).setDescriptorCount(32);
+  const vk::DescriptorPoolSize pool_sizes[] = {
+      {vk::DescriptorType::eUniformBufferDynamic, 32},
+      {vk::DescriptorType::eStorageBuffer, 32}};
 
   vk::DescriptorPoolCreateInfo create_info{};
   create_info.setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
       .setMaxSets(32)
-      .setPoolSizes(pool_size);
+      .setPoolSizes(pool_sizes);
 
   return device.createDescriptorPool(create_info);
 }
 
 auto create_descriptor_set_layout(const vk::Device device) {
-  vk::DescriptorSetLayoutBinding binding{};
-  binding.setBinding(0)
-      .setDescriptorType(vk::DescriptorType::eUniformBuffer)
+  vk::DescriptorSetLayoutBinding bindings[2]{};
+  bindings[0]
+      .setBinding(0)
+      .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
+      .setDescriptorCount(1)
+      .setStageFlags(vk::ShaderStageFlagBits::eVertex);
+  bindings[1]
+      .setBinding(1)
+      .setDescriptorType(vk::DescriptorType::eStorageBuffer)
       .setDescriptorCount(1)
       .setStageFlags(vk::ShaderStageFlagBits::eVertex);
 
   vk::DescriptorSetLayoutCreateInfo create_info{};
-  create_info.setBindings(binding);
+  create_info.setBindings(bindings);
 
   return device.createDescriptorSetLayout(create_info);
 }
 
-auto create_shader(const vk::Device device, const std::string &path) {
-  std::ifstream file(path, std::ios::binary | std::ios::ate);
-  const std::streamsize file_size = file.tellg();
-  file.seekg(0, std::ios::beg);
-
-  std::vector<uint32_t> bytes(file_size);
-  file.read(reinterpret_cast<char *>(bytes.data()), file_size);
+auto create_descriptor_set(const vk::Device device,
+                           const vk::DescriptorPool descriptor_pool,
+                           const vk::DescriptorSetLayout descriptor_set_layout,
+                           const vk::Buffer uniform_buffer,
+                           const vk::Buffer instance_buffer) {
+  vk::DescriptorSetAllocateInfo descriptor_set_allocate_info{};
+  descriptor_set_allocate_info.setDescriptorPool(descriptor_pool)
+      .setSetLayouts(descriptor_set_layout);
+
+  const auto descriptor_set =
+      device.allocateDescriptorSets(descriptor_set_allocate_info)[0];
+
+  vk::DescriptorBufferInfo descriptor_buffer_info{};
+  descriptor_buffer_info.setBuffer(uniform_buffer)
+      .setOffset(0)
+      .setRange(bufferSize);
+
+  vk::DescriptorBufferInfo instance_buffer_info{};
+  instance_buffer_info.setBuffer(instance_buffer)
+      .setOffset(0)
+      .setRange(VK_WHOLE_SIZE);
+
+  vk::WriteDescriptorSet descriptor_writes[2]{};
+  descriptor_writes[0]
+      .setDstSet(descriptor_set)
+      .setDstBinding(0)
+      .setDstArrayElement(0)
+      .setDescriptorCount(1)
+      .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
+      .setPBufferInfo(&descriptor_buffer_info);
+  descriptor_writes[1]
+      .setDstSet(descriptor_set)
+      .setDstBinding(1)
+      .setDstArrayElement(0)
+      .setDescriptorCount(1)
+      .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+      .setPBufferInfo(&instance_buffer_info);
 
-  vk::ShaderModuleCreateInfo create_info{};
-  create_info.setCode(bytes).setCodeSize(file_size);
+  device.updateDescriptorSets(descriptor_writes, nullptr);
 
-  return device.createShaderModule(create_info);
+  return descriptor_set;
 }
 
-auto create_pipeline(const vk::Device device, const vk::RenderPass render_pass,
-                     const vk::DescriptorSetLayout descriptor_set_layout,
-                     const vk::ShaderModule vertex_shader,
-                     const vk::ShaderModule fragment_shader,
-                     const uint32_t width, const uint32_t height)
-    -> std::tuple<vk::PipelineLayout, vk::Pipeline> {
+auto create_pipeline_layout(
+    const vk::Device device,
+    const vk::DescriptorSetLayout descriptor_set_layout) {
   vk::PipelineLayoutCreateInfo layout_create_info{};
   layout_create_info.setSetLayouts(descriptor_set_layout)
       .setPushConstantRanges(
@@ -671,116 +829,7 @@ auto create_pipeline(const vk::Device device, const vk::RenderPass render_pass,
               .setSize(sizeof PushConstants)
               .setStageFlags(vk::ShaderStageFlagBits::eVertex));
 
-  auto pipeline_layout = device.createPipelineLayout(layout_create_info);
-
-  auto binding_descriptors = mov::Vertex::get_binding_description();
-  auto attribute_descriptors = mov::Vertex::get_attribute_descriptions();
-
-  vk::PipelineVertexInputStateCreateInfo vertex_input_stage{};
-  vertex_input_stage.setVertexBindingDescriptions(binding_descriptors)
-      .setVertexAttributeDescriptions(attribute_descriptors);
-
-  vk::PipelineInputAssemblyStateCreateInfo input_assembly_stage{};
-  input_assembly_stage.setTopology(vk::PrimitiveTopology::eTriangleList)
-      .setPrimitiveRestartEnable(false);
-
-  vk::PipelineShaderStageCreateInfo vertex_shader_stage{};
-  vertex_shader_stage.setStage(vk::ShaderStageFlagBits::eVertex)
-      .setModule(vertex_shader)
-      .setPName("main");
-
-  const vk::Viewport viewport = {
-      0, 0, static_cast<float>(width), static_cast<float>(height), 0, 1};
-  const vk::Rect2D scissor = {{0, 0}, {width, height}};
-
-  vk::PipelineViewportStateCreateInfo viewport_stage{};
-  viewport_stage.setViewports(viewport).setScissors(scissor);
-
-  vk::PipelineRasterizationStateCreateInfo rasterization_stage{};
-  rasterization_stage.setDepthClampEnable(false)
-      .setRasterizerDiscardEnable(false)
-      .setPolygonMode(vk::PolygonMode::eFill)
-      .setLineWidth(1)
-      .setCullMode(vk::CullModeFlagBits::eNone)
-      .setFrontFace(vk::FrontFace::eCounterClockwise)
-      .setDepthBiasEnable(false)
-      .setDepthBiasConstantFactor(0)
-      .setDepthBiasClamp(0)
-      .setDepthBiasSlopeFactor(0);
-
-  vk::PipelineMultisampleStateCreateInfo multisample_stage{};
-  multisample_stage.setRasterizationSamples(vk::SampleCountFlagBits::e1)
-      .setSampleShadingEnable(false)
-      .setMinSampleShading(0.25);
-
-  vk::PipelineDepthStencilStateCreateInfo depth_stencil_stage{};
-  depth_stencil_stage.setDepthTestEnable(true)
-      .setDepthWriteEnable(true)
-      .setDepthCompareOp(vk::CompareOp::eLess)
-      .setDepthBoundsTestEnable(false)
-      .setMinDepthBounds(0)
-      .setMaxDepthBounds(1)
-      .setStencilTestEnable(false);
-
-  vk::PipelineShaderStageCreateInfo fragment_shader_stage{};
-  fragment_shader_stage.setStage(vk::ShaderStageFlagBits::eFragment)
-      .setModule(fragment_shader)
-      .setPName("main");
-
-  vk::PipelineColorBlendAttachmentState color_blend_attachment{};
-  color_blend_attachment
-      .setColorWriteMask(
-          vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
-          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA)
-      .setBlendEnable(true)
-      .setSrcColorBlendFactor(vk::BlendFactor::eSrcAlpha)
-      .setDstColorBlendFactor(vk::BlendFactor::eOneMinusSrcAlpha)
-      .setColorBlendOp(vk::BlendOp::eAdd)
-      .setSrcAlphaBlendFactor(vk::BlendFactor::eOne)
-      .setDstAlphaBlendFactor(vk::BlendFactor::eOne)
-      .setAlphaBlendOp(vk::BlendOp::eAdd);
-
-  vk::PipelineColorBlendStateCreateInfo color_blend_stage{};
-  color_blend_stage.setLogicOpEnable(false)
-      .setLogicOp(vk::LogicOp::eCopy)
-      .setAttachments(color_blend_attachment)
-      .setBlendConstants(std::array{0.f, 0.f, 0.f, 0.f});
-
-  vk::DynamicState dynamic_states[] = {vk::DynamicState::eViewport,
-                                       vk::DynamicState::eScissor};
-
-  vk::PipelineDynamicStateCreateInfo dynamic_state{};
-  dynamic_state.setDynamicStates(dynamic_states);
-
-  vk::PipelineShaderStageCreateInfo shader_stages[] = {vertex_shader_stage,
-                                                       fragment_shader_stage};
-
-  vk::GraphicsPipelineCreateInfo create_info{};
-  create_info.setStages(shader_stages)
-      .setPVertexInputState(&vertex_input_stage)
-      .setPInputAssemblyState(&input_assembly_stage)
-      .setPTessellationState(nullptr)
-      .setPViewportState(&viewport_stage)
-      .setPRasterizationState(&rasterization_stage)
-      .setPMultisampleState(&multisample_stage)
-      .setPDepthStencilState(&depth_stencil_stage)
-      .setPColorBlendState(&color_blend_stage)
-      .setPDynamicState(&dynamic_state)
-      .setLayout(pipeline_layout)
-      .setRenderPass(render_pass)
-      .setSubpass(0)
-      .setBasePipelineHandle(nullptr)
-      .setBasePipelineIndex(-1);
-
-  const auto result = device.createGraphicsPipeline(nullptr, create_info);
-
-  if (result.result != vk::Result::eSuccess) {
-    spdlog::error("Failed to create Vulkan pipeline: {}",
-                  vk::to_string(result.result));
-    return {VK_NULL_HANDLE, VK_NULL_HANDLE};
-  }
-
-  return {pipeline_layout, result.value};
+  return device.createPipelineLayout(layout_create_info);
 }
 
 auto create_session(const xr::Instance instance, const xr::SystemId system_id,
@@ -797,23 +846,6 @@ auto create_session(const xr::Instance instance, const xr::SystemId system_id,
   return instance.createSession(session_create_info);
 }
 
-auto get_resolution(const xr::Instance instance, const xr::SystemId system)
-    -> std::tuple<uint32_t, uint32_t> {
-  const std::vector<xr::ViewConfigurationView> config_views =
-      instance.enumerateViewConfigurationViewsToVector(
-          system, xr::ViewConfigurationType::PrimaryStereo);
-
-  uint32_t width = 0;
-  uint32_t height = 0;
-
-  for (const xr::ViewConfigurationView &view : config_views) {
-    width += view.recommendedImageRectWidth;
-    height = std::max(height, view.recommendedImageRectHeight);
-  }
-
-  return {width, height};
-}
-
 auto create_swapchains(const xr::Instance instance, const xr::SystemId system,
                        const xr::Session session)
     -> std::tuple<Swapchain *, Swapchain *> {
@@ -857,20 +889,62 @@ auto create_swapchains(const xr::Instance instance, const xr::SystemId system,
                         config_views[1].recommendedImageRectHeight)};
 }
 
+// One swapchain with a layer per eye, for rendering both eyes in a single
+// multiview pass. Both eyes share the larger of the recommended sizes.
+auto create_multiview_swapchain(const xr::Instance instance,
+                                const xr::SystemId system,
+                                const xr::Session session) -> Swapchain * {
+  const std::vector<xr::ViewConfigurationView> config_views =
+      instance.enumerateViewConfigurationViewsToVector(
+          system, xr::ViewConfigurationType::PrimaryStereo);
+
+  const std::vector<int64_t> formats =
+      session.enumerateSwapchainFormatsToVector();
+  int64_t chosen_format = formats.front();
+
+  for (const int64_t format : formats) {
+    if (format == VK_FORMAT_R8G8B8A8_SRGB) {
+      chosen_format = format;
+      break;
+    }
+  }
+
+  uint32_t width = 0;
+  uint32_t height = 0;
+
+  for (const xr::ViewConfigurationView &view : config_views) {
+    width = std::max(width, view.recommendedImageRectWidth);
+    height = std::max(height, view.recommendedImageRectHeight);
+  }
+
+  const xr::SwapchainCreateInfo swapchain_create_info{
+      xr::SwapchainCreateFlagBits::None,
+      xr::SwapchainUsageFlagBits::ColorAttachment,
+      chosen_format,
+      static_cast<uint32_t>(vk::SampleCountFlagBits::e1),
+      width,
+      height,
+      1,
+      static_cast<uint32_t>(eyeCount),
+      1};
+
+  return new Swapchain(session.createSwapchain(swapchain_create_info),
+                       static_cast<vk::Format>(chosen_format), width, height,
+                       static_cast<uint32_t>(eyeCount));
+}
+
 auto create_space(const xr::Session session,
                   xr::ReferenceSpaceType type = xr::ReferenceSpaceType::Stage) {
   return session.createReferenceSpace({type, {{0, 0, 0, 1}, {0, 0, 0}}});
 }
 
-auto update_projection_view_matrix(const vk::Device device, const xr::View view,
-                                   const SwapchainImage *image) {
-  const auto data =
-      static_cast<float *>(device.mapMemory(image->memory, 0, ~0, {}));
-
+auto projection_matrix(const xr::View &view,
+                       const float near_distance = nearDistance,
+                       const float far_distance = farDistance) {
   const float angle_width = tan(view.fov.angleRight) - tan(view.fov.angleLeft);
   const float angle_height = tan(view.fov.angleDown) - tan(view.fov.angleUp);
 
-  float projection_matrix[4][4]{{0}};
+  glm::mat4 projection_matrix(0.f);
 
   projection_matrix[0][0] = 2.0f / angle_width;
   projection_matrix[2][0] =
@@ -878,43 +952,148 @@ auto update_projection_view_matrix(const vk::Device device, const xr::View view,
   projection_matrix[1][1] = 2.0f / angle_height;
   projection_matrix[2][1] =
       (tan(view.fov.angleUp) + tan(view.fov.angleDown)) / angle_height;
-  projection_matrix[2][2] = -farDistance / (farDistance - nearDistance);
+  projection_matrix[2][2] = -far_distance / (far_distance - near_distance);
   projection_matrix[3][2] =
-      -(farDistance * nearDistance) / (farDistance - nearDistance);
+      -(far_distance * near_distance) / (far_distance - near_distance);
   projection_matrix[2][3] = -1;
 
-  auto view_matrix = inverse(
+  return projection_matrix;
+}
+
+auto view_matrix(const xr::View &view) {
+  return inverse(
       translate(glm::mat4(1.0f),
                 glm::vec3(view.pose.position.x, view.pose.position.y,
                           view.pose.position.z)) *
       mat4_cast(glm::quat(view.pose.orientation.w, view.pose.orientation.x,
                           view.pose.orientation.y, view.pose.orientation.z)));
+}
+
+auto write_projection_view_matrix(const xr::View &view, float *projection,
+                                  float *view_data) {
+  const auto projection_data = projection_matrix(view);
+  const auto view_matrix_data = view_matrix(view);
+
+  memcpy(projection, value_ptr(projection_data), sizeof(float) * 4 * 4);
+  memcpy(view_data, value_ptr(view_matrix_data), sizeof(float) * 4 * 4);
+}
+
+// One frustum enclosing both eyes, so the scene is culled once per frame:
+// its apex sits behind the eyes where the outer edges of the two views
+// meet, and it takes the wider vertical field of view. This needs parallel
+// views; canted displays get a frustum per eye instead.
+auto culling_frusta(const std::vector<xr::View> &views)
+    -> std::vector<mov::Frustum> {
+  const auto &left = views[0];
+  const auto &right = views[1];
+
+  const glm::quat orientation(left.pose.orientation.w, left.pose.orientation.x,
+                              left.pose.orientation.y, left.pose.orientation.z);
+  const glm::quat right_orientation(
+      right.pose.orientation.w, right.pose.orientation.x,
+      right.pose.orientation.y, right.pose.orientation.z);
+
+  const glm::vec3 left_position(left.pose.position.x, left.pose.position.y,
+                                left.pose.position.z);
+  const glm::vec3 right_position(right.pose.position.x, right.pose.position.y,
+                                 right.pose.position.z);
+  const auto separation = glm::length(right_position - left_position);
+
+  const auto tan_left = tan(left.fov.angleLeft);
+  const auto tan_right = tan(right.fov.angleRight);
+
+  if (std::abs(glm::dot(orientation, right_orientation)) < 0.99999f ||
+      separation <= 0.f || tan_right <= tan_left) {
+    return {mov::Frustum::from_matrix(projection_matrix(left) *
+                                      view_matrix(left)),
+            mov::Frustum::from_matrix(projection_matrix(right) *
+                                      view_matrix(right))};
+  }
+
+  const auto across = (right_position - left_position) / separation;
+  const auto forward = orientation * glm::vec3(0.f, 0.f, -1.f);
+
+  const auto back = separation / (tan_right - tan_left);
+  const auto apex = (left_position + right_position) * 0.5f -
+                    across * (separation * (tan_right + tan_left) * 0.5f /
+                              (tan_right - tan_left)) -
+                    forward * back;
+
+  xr::View combined = left;
+  combined.pose.position = {apex.x, apex.y, apex.z};
+  combined.fov.angleRight = right.fov.angleRight;
+  combined.fov.angleUp = std::max(left.fov.angleUp, right.fov.angleUp);
+  combined.fov.angleDown = std::min(left.fov.angleDown, right.fov.angleDown);
+
+  return {mov::Frustum::from_matrix(
+      projection_matrix(combined, nearDistance, farDistance + back) *
+      view_matrix(combined))};
+}
+
+// Fills slots [0, view_count) of the per-eye matrix arrays.
+auto update_projection_view_matrix(const xr::View *views,
+                                   const uint32_t view_count,
+                                   mov::UniformRing &uniforms) {
+  const auto [memory, offset] = uniforms.allocate(bufferSize);
+  const auto data = static_cast<float *>(memory);
+
+  for (uint32_t i = 0; i < view_count; i++)
+    write_projection_view_matrix(views[i], data + 4 * 4 * i,
+                                 data + 4 * 4 * (eyeCount + i));
 
-  memcpy(data, projection_matrix, sizeof(float) * 4 * 4);
-  memcpy(4 * 4 + data, value_ptr(view_matrix), sizeof(float) * 4 * 4);
+  return offset;
 }
 
-auto render_eye(Swapchain *swapchain,
-                const std::vector<SwapchainImage *> &images, xr::View view,
-                vk::Device device, vk::Queue queue, vk::RenderPass render_pass,
-                vk::PipelineLayout pipeline_layout, vk::Pipeline pipeline) {
+// Records view_count views into one swapchain in a single pass: one eye per
+// swapchain on the two-pass path, or both eyes into a layered swapchain with
+// multiview. The image stays acquired until the frame has been submitted.
+auto render_views(Swapchain *swapchain,
+                  const std::vector<SwapchainImage *> &images,
+                  const vk::Extent2D extent,
+                  const xr::View *views, uint32_t view_count,
+                  uint32_t frame_slot, mov::FrameScheduler &scheduler,
+                  mov::GpuProfiler &profiler, const std::string &pass_name,
+                  vk::RenderPass render_pass,
+                  vk::PipelineLayout pipeline_layout, vk::Pipeline pipeline,
+                  vk::Pipeline instanced_pipeline,
+                  vk::DescriptorSet descriptor_set,
+                  vk::DescriptorSet culled_descriptor_set,
+                  vk::DescriptorSet meshlet_descriptor_set,
+                  mov::UniformRing &uniforms, mov::InstanceBatcher &instances,
+                  const mov::GpuCuller &culler,
+                  const mov::GpuCuller &meshlet_culler,
+                  const mov::GeometryPool &geometry,
+                  mov::ParallelRecorder &recorder,
+                  mov::CommandCache &static_commands,
+                  const std::vector<mov::GameObject *> &visible) {
+  MOV_TRACE_ZONE("render_views");
+
   uint32_t active_index;
 
-  swapchain->swapchain.acquireSwapchainImage({}, &active_index);
+  {
+    MOV_TRACE_ZONE("acquireSwapchainImage");
+    swapchain->swapchain.acquireSwapchainImage({}, &active_index);
+  }
 
-  swapchain->swapchain.waitSwapchainImage(
-      {xr::Duration{std::numeric_limits<int64_t>::max()}});
+  {
+    MOV_TRACE_ZONE("waitSwapchainImage");
+    swapchain->swapchain.waitSwapchainImage(
+        {xr::Duration{std::numeric_limits<int64_t>::max()}});
+  }
 
   const SwapchainImage *image = images[active_index];
 
-  update_projection_view_matrix(device, view, image);
+  const auto uniform_offset =
+      update_projection_view_matrix(views, view_count, uniforms);
 
-  device.unmapMemory(image->memory);
+  const auto primary = scheduler.command_buffer();
 
   vk::CommandBufferBeginInfo begin_info{};
   begin_info.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
 
-  image->commandBuffer.begin(&begin_info);
+  primary.begin(&begin_info);
+
+  const auto pass_scope = profiler.begin(primary, pass_name);
 
   vk::ClearValue clear_value{};
   clear_value.setColor({0.f, 0.f, 0.f, 1.f});
@@ -926,91 +1105,340 @@ auto render_eye(Swapchain *swapchain,
 
   vk::RenderPassBeginInfo begin_render_pass_info{};
   begin_render_pass_info.setRenderPass(render_pass)
-      .setFramebuffer(image->framebuffer)
-      .setRenderArea({{0, 0}, {(swapchain->width), (swapchain->height)}})
+      .setFramebuffer(image->framebuffers[frame_slot])
+      .setRenderArea({{0, 0}, extent})
       .setClearValues(clear_values);
 
-  image->commandBuffer.beginRenderPass(&begin_render_pass_info,
-                                       vk::SubpassContents::eInline);
+  primary.beginRenderPass(&begin_render_pass_info,
+                          vk::SubpassContents::eSecondaryCommandBuffers);
 
-  vk::Viewport viewport = {0,
-                           0,
-                           static_cast<float>(swapchain->width),
-                           static_cast<float>(swapchain->height),
-                           0,
-                           1};
+  const vk::Viewport viewport = {0,
+                                 0,
+                                 static_cast<float>(extent.width),
+                                 static_cast<float>(extent.height),
+                                 0,
+                                 1};
 
-  image->commandBuffer.setViewport(0, 1, &viewport);
+  const vk::Rect2D scissor = {{0, 0}, extent};
+
+  vk::CommandBufferInheritanceInfo inheritance{};
+  inheritance.setRenderPass(render_pass)
+      .setSubpass(0)
+      .setFramebuffer(image->framebuffers[frame_slot]);
+
+  // Secondary command buffers start without any bound state.
+  const auto bind = [&](const vk::CommandBuffer commands,
+                        const vk::Pipeline bound_pipeline,
+                        const vk::DescriptorSet bound_descriptor_set) {
+    commands.setViewport(0, 1, &viewport);
+    commands.setScissor(0, 1, &scissor);
+    commands.bindPipeline(vk::PipelineBindPoint::eGraphics, bound_pipeline);
+    commands.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                pipeline_layout, 0, 1, &bound_descriptor_set,
+                                1, &uniform_offset);
+    geometry.bind(commands);
+  };
 
-  vk::Rect2D scissor = {{0, 0}, {swapchain->width, swapchain->height}};
+  // Cached commands are replayed over many frames, so they cannot hold this
+  // frame's queries; they only show up in the pass's total.
+  if (!crowd.empty() && cacheCrowd) {
+    const mov::CommandCacheKey key{image->framebuffers[frame_slot],
+                                   instanced_pipeline, uniform_offset,
+                                   crowdVersion, extent,
+                                   culler.object_count()};
+
+    primary.executeCommands(static_commands.get(
+        key, inheritance, [&](const vk::CommandBuffer commands) {
+          bind(commands, instanced_pipeline, culled_descriptor_set);
+          culler.draw(commands);
+        }));
+  }
 
-  image->commandBuffer.setScissor(0, 1, &scissor);
+  recorder.record(primary, inheritance,
+                  static_cast<uint32_t>(visible.size()),
+                  [&](const vk::CommandBuffer commands, const uint32_t begin,
+                      const uint32_t end) {
+                    const auto scope =
+                        profiler.begin(commands, "objects", view_count);
+                    bind(commands, pipeline, descriptor_set);
+
+                    for (uint32_t i = begin; i < end; i++)
+                      visible[i]->draw(commands, pipeline_layout);
+                    profiler.end(commands, scope);
+                  });
+
+  // The instanced and indirect paths are a handful of commands, so they
+  // are recorded by the calling thread alone. Meshlets change every frame,
+  // so unlike the crowd they are never cached.
+  if (meshletCulling) {
+    recorder.record(
+        primary, inheritance, 1,
+        [&](const vk::CommandBuffer commands, uint32_t, uint32_t) {
+          const auto scope = profiler.begin(commands, "meshlets", view_count);
+          bind(commands, instanced_pipeline, meshlet_descriptor_set);
+          meshlet_culler.draw(commands);
+          profiler.end(commands, scope);
+        });
+  }
 
-  image->commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+  if (!crowd.empty() && !cacheCrowd && (gpuCulling || batchCrowd)) {
+    recorder.record(
+        primary, inheritance, 1,
+        [&](const vk::CommandBuffer commands, uint32_t, uint32_t) {
+          const auto scope = profiler.begin(commands, "crowd", view_count);
+          if (gpuCulling) {
+            bind(commands, instanced_pipeline, culled_descriptor_set);
+            culler.draw(commands);
+          } else {
+            bind(commands, instanced_pipeline, descriptor_set);
+            instances.draw(commands);
+          }
+          profiler.end(commands, scope);
+        });
+  }
 
-  image->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                          pipeline_layout, 0, 1,
-                                          &image->descriptorSet, 0, nullptr);
+  primary.endRenderPass();
+  profiler.end(primary, pass_scope);
+  primary.end();
 
-  object.transform.move_abs(glm::vec3(objectPos.x, objectPos.y, objectPos.z));
-  object.draw(image->commandBuffer, pipeline_layout);
+  return true;
+}
 
+auto render(const xr::Session session,
+            const std::vector<Swapchain *> &swapchains,
+            const std::vector<std::vector<SwapchainImage *>> &swapchain_images,
+            const xr::Space space, xr::Time predicted_display_type,
+            const uint64_t frame, const VkQueue queue,
+            const VkRenderPass render_pass,
+            const VkPipelineLayout pipeline_layout, const VkPipeline pipeline,
+            const VkPipeline instanced_pipeline,
+            const VkDescriptorSet descriptor_set,
+            const VkDescriptorSet culled_descriptor_set,
+            const VkDescriptorSet meshlet_descriptor_set,
+            mov::UniformRing &uniforms, mov::InstanceBatcher &instances,
+            mov::GpuCuller &culler, mov::GpuCuller &meshlet_culler,
+            mov::FrustumCuller &frustum_culler,
+            const mov::GeometryPool &geometry,
+            mov::ParallelRecorder &recorder,
+            mov::CommandCache &static_commands,
+            mov::FrameScheduler &scheduler,
+            mov::DynamicResolution &resolution, mov::GpuProfiler &profiler) {
+  MOV_TRACE_ZONE("render");
+
+  const auto frame_slot = scheduler.begin_frame(frame);
+
+  // The slot's queries are reset ahead of everything else in the frame.
+  {
+    const auto commands = scheduler.command_buffer();
+
+    commands.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    profiler.begin_frame(frame_slot, commands);
+    commands.end();
+  }
+
+  if (dynamicResolution) {
+    const auto gpu_time = scheduler.last_gpu_time();
+    const auto scale = resolution.update(frame_slot, gpu_time);
+
+    spdlog::trace("GPU time {:.2f} ms, resolution scale {:.2f}",
+                  std::chrono::duration<float, std::milli>(gpu_time).count(),
+                  scale);
+  }
+
+  spdlog::trace("Waited {} us for the GPU before frame {}",
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    scheduler.last_gpu_wait())
+                    .count(),
+                frame);
+
+  {
+    MOV_TRACE_ZONE("beginFrame");
+    session.beginFrame({});
+  }
+
+  XrViewState view_state{.type = XR_TYPE_VIEW_STATE};
+
+  constexpr uint32_t view_count = eyeCount;
+  const std::vector<xr::View> views = [&] {
+    MOV_TRACE_ZONE("locateViews");
+    return session.locateViewsToVector(
+        {xr::ViewConfigurationType::PrimaryStereo, predicted_display_type,
+         space},
+        &view_state);
+  }();
+
+  uniforms.begin_frame(frame_slot);
+  instances.begin_frame(frame_slot);
+  recorder.begin_frame(frame_slot);
+  static_commands.begin_frame();
+
+  // Both passes draw the same culled list, so keep whatever either eye sees.
+  glm::mat4 view_projections[eyeCount];
+  glm::vec3 view_positions[eyeCount];
+  for (size_t i = 0; i < eyeCount; i++) {
+    const auto &position = views[i].pose.position;
+
+    view_projections[i] = projection_matrix(views[i]) * view_matrix(views[i]);
+    view_positions[i] = glm::vec3(position.x, position.y, position.z);
+  }
+
+  culler.begin_frame(frame_slot, view_projections, view_positions,
+                     view_count);
+  meshlet_culler.begin_frame(frame_slot, view_projections, view_positions,
+                             view_count);
+
+  object.transform.move_abs(glm::vec3(objectPos.x, objectPos.y, objectPos.z));
   controller.transform
       .move_abs(glm::vec3(right_hand_pos.x, right_hand_pos.y, right_hand_pos.z))
       .rotate_abs(glm::quat(right_hand_orientation.w, right_hand_orientation.x,
                             right_hand_orientation.y,
                             right_hand_orientation.z));
-  controller.draw(image->commandBuffer, pipeline_layout);
 
-  image->commandBuffer.endRenderPass();
-  image->commandBuffer.end();
+  // Both eyes render the same share of their images, to keep them equally
+  // sharp.
+  std::vector<vk::Extent2D> extents;
+  for (const auto swapchain : swapchains)
+    extents.push_back(dynamicResolution
+                          ? resolution.extent(swapchain->width,
+                                              swapchain->height)
+                          : vk::Extent2D{swapchain->width, swapchain->height});
+
+  // Everything the GPU does not cull goes through the CPU culler: the two
+  // push-constant objects first, then the crowd unless the GPU culls it.
+  std::vector<mov::GameObject *> objects = {&object, &controller};
+
+  // The eyes are close enough together to share one level per object, as
+  // long as it holds up in the sharper of the two. Errors are measured in
+  // rendered pixels, so a lower resolution scale picks coarser levels.
+  mov::LodView lod_view{};
+  lod_view.max_pixel_error = lodPixelError;
+  for (size_t i = 0; i < eyeCount; i++) {
+    const auto tangent_height =
+        tan(views[i].fov.angleUp) - tan(views[i].fov.angleDown);
 
-  vk::PipelineStageFlags stage_mask =
-      vk::PipelineStageFlagBits::eColorAttachmentOutput;
+    lod_view.position += view_positions[i] / static_cast<float>(eyeCount);
+    lod_view.projection_scale =
+        std::max(lod_view.projection_scale,
+                 static_cast<float>(extents[0].height) / tangent_height);
+  }
 
-  vk::SubmitInfo submit_info{};
-  submit_info.setWaitDstStageMask(stage_mask)
-      .setCommandBuffers(image->commandBuffer)
-      .setWaitSemaphoreCount(0);
+  for (const auto lod_object : objects)
+    lod_object->select_lod(lod_view);
 
-  queue.submit(1, &submit_info, nullptr);
+  // The controller's meshlets are culled on the GPU instead.
+  if (meshletCulling) {
+    controller.submit(meshlet_culler);
+    objects.pop_back();
+  }
 
-  swapchain->swapchain.releaseSwapchainImage({});
+  const auto direct_count = objects.size();
 
-  return true;
-}
+  if (!gpuCulling)
+    for (auto &member : crowd)
+      objects.push_back(&member);
 
-auto render(const xr::Session session, Swapchain *swapchains[2],
-            std::vector<SwapchainImage *> swapchain_images[2],
-            const xr::Space space, xr::Time predicted_display_type,
-            const VkDevice device, const VkQueue queue,
-            const VkRenderPass render_pass,
-            const VkPipelineLayout pipeline_layout, const VkPipeline pipeline) {
-  session.beginFrame({});
+  std::vector<uint32_t> visible_indices;
+  {
+    MOV_TRACE_ZONE("cull");
 
-  XrViewState view_state{.type = XR_TYPE_VIEW_STATE};
+    frustum_culler.clear();
+    for (const auto culled_object : objects)
+      frustum_culler.add(culled_object->bounding_sphere());
 
-  constexpr uint32_t view_count = eyeCount;
-  const std::vector<xr::View> views = session.locateViewsToVector(
-      {xr::ViewConfigurationType::PrimaryStereo, predicted_display_type, space},
-      &view_state);
+    const auto frusta = culling_frusta(views);
 
-  for (size_t i = 0; i < eyeCount; i++) {
-    render_eye(swapchains[i], swapchain_images[i], views[i], device, queue,
-               render_pass, pipeline_layout, pipeline);
+    frustum_culler.cull(frusta.data(), static_cast<uint32_t>(frusta.size()),
+                        visible_indices);
+  }
+
+  std::vector<mov::GameObject *> visible;
+  for (const auto index : visible_indices) {
+    if (index < direct_count || !batchCrowd)
+      visible.push_back(objects[index]);
+    else
+      objects[index]->batch(instances);
+  }
+
+  if (gpuCulling)
+    for (auto &member : crowd)
+      member.submit(culler);
+
+  const auto cull_crowd = gpuCulling && !crowd.empty();
+
+  if (cull_crowd || meshletCulling) {
+    const auto commands = scheduler.command_buffer();
+
+    commands.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    const auto scope = profiler.begin(commands, "cull");
+    if (cull_crowd)
+      culler.dispatch(commands);
+    if (meshletCulling)
+      meshlet_culler.dispatch(commands);
+    profiler.end(commands, scope);
+    commands.end();
   }
 
+  const bool multiview = swapchains.size() == 1;
+
+  if (multiview) {
+    render_views(swapchains[0], swapchain_images[0], extents[0], views.data(),
+                 view_count, frame_slot, scheduler, profiler, "eyes",
+                 render_pass, pipeline_layout, pipeline, instanced_pipeline,
+                 descriptor_set, culled_descriptor_set, meshlet_descriptor_set,
+                 uniforms, instances, culler, meshlet_culler, geometry,
+                 recorder, static_commands, visible);
+  } else {
+    for (size_t i = 0; i < eyeCount; i++) {
+      render_views(swapchains[i], swapchain_images[i], extents[i], &views[i], 1,
+                   frame_slot, scheduler, profiler, fmt::format("eye {}", i),
+                   render_pass, pipeline_layout, pipeline,
+                   instanced_pipeline, descriptor_set, culled_descriptor_set,
+                   meshlet_descriptor_set, uniforms, instances, culler,
+                   meshlet_culler, geometry, recorder, static_commands,
+                   visible);
+    }
+  }
+
+  // Both eyes, and the cull pass before them, go out in one submit; the
+  // runtime only takes the images back once their rendering is submitted.
+  {
+    MOV_TRACE_ZONE("submit");
+    scheduler.submit(queue);
+  }
+
+  for (const auto swapchain : swapchains)
+    swapchain->swapchain.releaseSwapchainImage({});
+
+  if (verifyGpuCulling && (cull_crowd || meshletCulling)) {
+    vkQueueWaitIdle(queue);
+
+    if (cull_crowd && !culler.verify())
+      spdlog::warn("GPU culling disagrees with the CPU on frame {}", frame);
+    if (meshletCulling && !meshlet_culler.verify())
+      spdlog::warn("Meshlet culling disagrees with the CPU on frame {}",
+                   frame);
+  }
+
+  const auto cache_stats = static_commands.frame_stats();
+  spdlog::trace("Static commands: {} cache hits, {} re-recorded",
+                cache_stats.hits, cache_stats.records);
+
   xr::CompositionLayerProjectionView projected_views[2]{};
 
   for (size_t i = 0; i < eyeCount; i++) {
+    const auto swapchain = swapchains[multiview ? 0 : i];
+    const auto &extent = extents[multiview ? 0 : i];
+
     projected_views[i].pose = views[i].pose;
     projected_views[i].fov = views[i].fov;
     projected_views[i].subImage =
-        xr::SwapchainSubImage{swapchains[i]->swapchain,
+        xr::SwapchainSubImage{swapchain->swapchain,
                               {{0, 0},
-                               {static_cast<int32_t>(swapchains[i]->width),
-                                static_cast<int32_t>(swapchains[i]->height)}},
-                              0};
+                               {static_cast<int32_t>(extent.width),
+                                static_cast<int32_t>(extent.height)}},
+                              multiview ? static_cast<uint32_t>(i) : 0};
   }
 
   const xr::CompositionLayerProjection layer{
@@ -1019,6 +1447,7 @@ auto render(const xr::Session session, Swapchain *swapchains[2],
   auto p_layer =
       reinterpret_cast<const xr::CompositionLayerBaseHeader *>(&layer);
 
+  MOV_TRACE_ZONE("endFrame");
   session.endFrame(
       {predicted_display_type, xr::EnvironmentBlendMode::Opaque, 1, &p_layer});
   return true;
@@ -1147,44 +1576,42 @@ auto input(const xr::Session session, const xr::ActionSet action_set,
 
 std::string get_steam_install_location();
 
-auto process_mesh(mov::VkBufferProvider provider, aiMesh *mesh,
+auto process_mesh(mov::GeometryPool &geometry, aiMesh *mesh,
                   const aiScene *scene) {
-  std::vector<mov::Vertex> vertices;
-  std::vector<unsigned int> indices;
+  const auto [vertices, indices] = mov::core::import_mesh(mesh);
   // std::vector<mov::Texture> textures;
 
-  for (auto i = 0u; i < mesh->mNumVertices; ++i) {
-    mov::Vertex vertex;
-    glm::vec3 vector;
-
-    vector.x = mesh->mVertices[i].x;
-    vector.y = mesh->mVertices[i].y;
-    vector.z = mesh->mVertices[i].z;
-    vertex.pos = vector;
-
-    if (mesh->mTextureCoords[0]) {
-      glm::vec2 vec;
-      vec.x = mesh->mTextureCoords[0][i].x;
-      vec.y = mesh->mTextureCoords[0][i].y;
-      // vertex.tex_coords = vec;
-    } else {
-      // vertex.tex_coords = glm::vec2(0.0f, 0.0f);
-    }
-
-    vector.x = mesh->mNormals[i].x;
-    vector.y = mesh->mNormals[i].y;
-    vector.z = mesh->mNormals[i].z;
-    // vertex.normal = vector;
-
-    vertex.color = glm::vec3(1.0);
-
-    vertices.push_back(vertex);
-  }
-
-  for (auto i = 0u; i < mesh->mNumFaces; ++i) {
-    const auto face = mesh->mFaces[i];
-    for (auto j = 0u; j < face.mNumIndices; ++j)
-      indices.push_back(face.mIndices[j]);
+  auto levels = generateLods
+                    ? mov::generate_lods(indices, vertices, lodSettings)
+                    : std::vector<mov::SimplifiedMesh>{{indices, 0.f}};
+
+  std::vector<mov::MeshLod> lods;
+  for (auto &[level_indices, error] : levels) {
+    // Simplified levels only use some of the vertices; the rest are dropped
+    // either way.
+    auto level_vertices = vertices;
+    if (optimizeMeshes)
+      mov::optimize_mesh(level_indices, level_vertices);
+    else if (!lods.empty())
+      mov::optimize_vertex_fetch(level_indices, level_vertices);
+
+    auto meshlets = meshletCulling
+                        ? mov::build_meshlets(level_indices, level_vertices,
+                                              meshletConeCulling)
+                        : std::vector<mov::Meshlet>{};
+
+    spdlog::debug("Mesh LOD {}: {} triangles, {} vertices, {} meshlets, "
+                  "error {}",
+                  lods.size(), level_indices.size() / 3,
+                  level_vertices.size(), meshlets.size(), error);
+
+    // Meshlets are culled on the GPU, which needs 32-bit indices.
+    const auto compact = compactIndices && !meshletCulling;
+
+    lods.push_back({mov::Mesh(geometry, level_vertices, level_indices,
+                              vertexFormat, std::move(meshlets),
+                              compact /*, textures*/),
+                    error});
   }
 
   /*if (mesh->mMaterialIndex >= 0)
@@ -1199,40 +1626,37 @@ auto process_mesh(mov::VkBufferProvider provider, aiMesh *mesh,
   specular_maps.end());
   }*/
 
-  return mov::Mesh(provider, vertices, indices /*, textures*/);
+  return mov::LodChain(std::move(lods));
 }
 
-auto process_node(mov::VkBufferProvider provider, aiNode *node,
-                  const aiScene *scene) -> std::vector<mov::Mesh> {
-  std::vector<mov::Mesh> meshes;
+auto process_node(mov::GeometryPool &geometry, aiNode *node,
+                  const aiScene *scene) -> std::vector<mov::LodChain> {
+  std::vector<mov::LodChain> meshes;
 
   for (auto i = 0u; i < node->mNumMeshes; ++i) {
     const auto mesh = scene->mMeshes[node->mMeshes[i]];
-    meshes.push_back(process_mesh(provider, mesh, scene));
+    meshes.push_back(process_mesh(geometry, mesh, scene));
   }
 
   for (auto i = 0u; i < node->mNumChildren; ++i) {
-    const auto child_meshes = process_node(provider, node->mChildren[i], scene);
+    const auto child_meshes = process_node(geometry, node->mChildren[i], scene);
     meshes.insert(meshes.end(), child_meshes.begin(), child_meshes.end());
   }
 
   return meshes;
 }
 
-auto load_model(mov::VkBufferProvider provider, std::string path) {
+auto load_model(mov::GeometryPool &geometry, std::string path) {
   Assimp::Importer importer;
 
-  const auto flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-                     aiProcess_JoinIdenticalVertices | aiProcess_SortByPType;
-
-  const auto scene = importer.ReadFile(path, flags);
+  const auto scene = importer.ReadFile(path, mov::core::importFlags);
   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
       !scene->mRootNode) {
     spdlog::error("Failed to load model: {}", importer.GetErrorString());
-    return std::vector<mov::Mesh>{};
+    return std::vector<mov::LodChain>{};
   }
 
-  return process_node(provider, scene->mRootNode, scene);
+  return process_node(geometry, scene->mRootNode, scene);
 }
 
 int main(int, char **) {
@@ -1253,65 +1677,240 @@ int main(int, char **) {
 
   auto [physicalDevice, deviceExtensions] =
       get_vulkan_device_requirements(instance, system, vulkan_instance);
-  const auto graphics_queue_family_index =
-      get_device_queue_family(physicalDevice);
-  auto [device, queue] = create_device(
-      physicalDevice, graphics_queue_family_index, deviceExtensions);
-
-  const auto render_pass = create_render_pass(device, physicalDevice);
-  const auto command_pool =
-      create_command_pool(device, graphics_queue_family_index);
+  const auto queue_families = get_device_queue_families(physicalDevice);
+  const auto graphics_queue_family_index = queue_families.graphics;
+
+  const auto instance_api_version =
+      static_cast<uint32_t>(graphicsRequirements.minApiVersionSupported.get());
+
+  const auto memory_budget_supported =
+      supports_memory_budget(physicalDevice, instance_api_version);
+  if (memory_budget_supported)
+    deviceExtensions.insert(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+  DeviceFeatures features{};
+  features.multiview =
+      preferMultiview &&
+      supports_multiview(physicalDevice, instance_api_version);
+  features.draw_indirect_count =
+      supports_draw_indirect_count(physicalDevice, instance_api_version);
+  features.multi_draw_indirect =
+      vk::PhysicalDevice(physicalDevice).getFeatures().multiDrawIndirect;
+
+  const auto creation_feedback =
+      supports_pipeline_creation_feedback(physicalDevice);
+  if (creation_feedback)
+    deviceExtensions.insert(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+
+  const auto multiview = features.multiview;
+  const auto view_count = multiview ? static_cast<uint32_t>(eyeCount) : 1u;
+
+  spdlog::info("Stereo rendering: {}",
+               multiview ? "single pass (multiview)" : "one pass per eye");
+  spdlog::info("Indirect draws: {}",
+               features.draw_indirect_count   ? "compacted with a count buffer"
+               : features.multi_draw_indirect ? "one multi-draw"
+                                              : "one call per object");
+
+  auto [device, queue, transfer_queue, compute_queue] = create_device(
+      physicalDevice, queue_families, deviceExtensions, features);
+
+  const auto depth_format =
+      mov::find_depth_format(physicalDevice, nearDistance, farDistance);
+  const auto render_pass = create_render_pass(device, depth_format, view_count);
+  // Frames are only timed where the graphics queue writes timestamps.
+  const vk::PhysicalDevice timed_device(physicalDevice);
+  const auto timestamp_period =
+      timed_device.getQueueFamilyProperties()[graphics_queue_family_index]
+                  .timestampValidBits > 0
+          ? timed_device.getProperties().limits.timestampPeriod
+          : 0.f;
+  if (dynamicResolution && timestamp_period == 0.f)
+    spdlog::warn("No GPU timestamps; rendering at full resolution");
+
+  mov::FrameScheduler scheduler(device, graphics_queue_family_index,
+                                framesInFlight, timestamp_period);
+  mov::DynamicResolution resolution(dynamicResolutionSettings,
+                                    framesInFlight);
+  // Labels need no timestamps, so the profiler runs either way.
+  mov::GpuProfiler profiler(vulkan_instance, device, framesInFlight,
+                            gpuProfiling ? timestamp_period : 0.f);
   const auto descriptor_pool = create_descriptor_pool(device);
   const auto descriptor_set_layout = create_descriptor_set_layout(device);
-  const auto vertex_shader = create_shader(device, "data\\vertex.vert.spv");
-  const auto fragment_shader = create_shader(device, "data\\fragment.frag.spv");
-
-  const auto [width, height] = get_resolution(instance, system);
-
-  auto [pipelineLayout, pipeline] =
-      create_pipeline(device, render_pass, descriptor_set_layout, vertex_shader,
-                      fragment_shader, width, height);
+  const auto shader_directory = shader_override_directory();
+  mov::ShaderRegistry shader_registry(mov::shaders::all, shader_directory);
+  const auto cull_shader = shader_registry.create_module(device, "cull.comp");
+
+  mov::PipelineCache pipeline_cache(device, physicalDevice, pipelineCachePath,
+                                    creation_feedback);
+  spdlog::info("Pipeline cache {}: {}", pipelineCachePath,
+               mov::to_string(pipeline_cache.load_result()));
+
+  const auto pipelineLayout =
+      create_pipeline_layout(device, descriptor_set_layout);
+
+  // Objects asking for the same variant share one pipeline. The instanced
+  // variant reads model matrices from the instance buffer by
+  // gl_InstanceIndex instead of from push constants.
+  mov::PipelineVariants pipelines(device, pipeline_cache, shader_registry);
+  const mov::PipelineKey pipeline_key{render_pass, pipelineLayout, view_count,
+                                      vertexFormat};
+  auto instanced_key = pipeline_key;
+  instanced_key.instanced = true;
+
+  const auto pipeline = pipelines.get(pipeline_key);
+  const auto instanced_pipeline = pipelines.get(instanced_key);
+
+  if (shader_registry.overridden() > 0)
+    spdlog::info("Loaded {} shaders from {}", shader_registry.overridden(),
+                 shader_directory);
 
   spdlog::info("Found Steam: {}", get_steam_install_location());
 
-  auto provider =
-      mov::VkBufferProvider(device, physicalDevice, command_pool, queue);
+  mov::VkAllocator allocator(device, physicalDevice);
+  mov::VkUploader uploader(allocator, queue_families.transfer, transfer_queue,
+                           queue_families.graphics, queue);
+
+  auto provider = mov::VkBufferProvider(allocator, uploader);
+  mov::GeometryPool geometry(
+      provider, mov::GeometryPool::default_vertex_capacity,
+      mov::GeometryPool::default_index_capacity, framesInFlight + 1);
+  mov::UniformRing uniforms(allocator, framesInFlight);
+  mov::InstanceBatcher instances(allocator, framesInFlight);
+  mov::FrustumCuller frustum_culler;
+  mov::ParallelRecorder recorder(device, graphics_queue_family_index,
+                                 framesInFlight);
+  mov::CommandCache static_commands(device, graphics_queue_family_index);
+  mov::GpuCuller culler(allocator, pipeline_cache, cull_shader,
+                        framesInFlight, features.draw_indirect_count,
+                        features.multi_draw_indirect, verifyGpuCulling);
+  // Cull shader and layout are shared, but meshlets are drawn from their own
+  // buffers so the crowd's cached commands stay valid.
+  mov::GpuCuller meshlet_culler(allocator, pipeline_cache, cull_shader,
+                                framesInFlight, features.draw_indirect_count,
+                                features.multi_draw_indirect,
+                                verifyGpuCulling);
+
+  // Every pipeline exists by now; saving here keeps them even if the session
+  // never shuts down cleanly.
+  if (!pipeline_cache.save())
+    spdlog::warn("Failed to write the pipeline cache to {}",
+                 pipelineCachePath);
+
+  const auto pipeline_stats = pipeline_cache.stats();
+  spdlog::info("Pipelines: {} created in {:.2f} ms{}",
+               pipeline_stats.pipelines, pipeline_stats.creation_ms(),
+               pipeline_stats.feedback
+                   ? fmt::format(", {} from the cache, saving about {:.2f} ms",
+                                 pipeline_stats.hits, pipeline_stats.saved_ms())
+                   : "");
+
+  mov::MemoryBudget memory_budget(allocator, memory_budget_supported);
+  memory_budget.on_threshold(
+      0.8f, [](const uint32_t heap, const mov::MemoryHeapReport &report) {
+        spdlog::warn("Memory heap {} is at {:.1f}% of its budget ({} / {} "
+                     "bytes)",
+                     heap, report.share() * 100.f, report.usage, report.budget);
+      });
+
+  const auto descriptor_set =
+      create_descriptor_set(device, descriptor_pool, descriptor_set_layout,
+                            uniforms.buffer(), instances.buffer());
+  const auto culled_descriptor_set =
+      create_descriptor_set(device, descriptor_pool, descriptor_set_layout,
+                            uniforms.buffer(), culler.instance_buffer());
+  const auto meshlet_descriptor_set = create_descriptor_set(
+      device, descriptor_pool, descriptor_set_layout, uniforms.buffer(),
+      meshlet_culler.instance_buffer());
 
   controller = load_model(
-      provider,
+      geometry,
       get_steam_install_location() +
           "/steamapps/common/SteamVR/resources/rendermodels/"
           "oculus_quest2_controller_right/oculus_quest2_controller_right.obj")
       [0];
-  object = mov::Mesh(provider, vertices, indices);
+  // The object is drawn with push constants, so its indices can be 16-bit;
+  // the crowd's copy keeps 32-bit ones for the GPU culler.
+  object = mov::Mesh(geometry, vertices, indices, vertexFormat, {},
+                     compactIndices);
+  const auto quad = mov::Mesh(geometry, vertices, indices, vertexFormat);
+
+  const auto crowd_count = crowd_size();
+  spdlog::info("Crowd: {} copies of the quad", crowd_count);
+
+  for (uint32_t i = 0; i < crowd_count; i++) {
+    auto &member = crowd.emplace_back(quad);
+    member.transform.move_abs(
+        glm::vec3((static_cast<float>(i % 100) - 50) * 1.5f,
+                  static_cast<float>(i / 100) * 1.5f, -20.f));
+  }
+  crowdVersion++;
+
+  uploader.flush();
+
+  const auto memory_stats = allocator.stats();
+  spdlog::info("Device memory: {} allocations in {} blocks, {} / {} bytes "
+               "used, {:.1f}% fragmented",
+               memory_stats.allocation_count, memory_stats.block_count,
+               memory_stats.used, memory_stats.reserved,
+               memory_stats.fragmentation() * 100.f);
+
+  const auto geometry_stats = geometry.stats();
+  spdlog::info("Geometry pool: {} meshes, {:.2f}% of vertex and {:.2f}% of "
+               "index capacity in use",
+               geometry_stats.allocation_count,
+               geometry_stats.vertex_occupancy() * 100.f,
+               geometry_stats.index_occupancy() * 100.f);
 
   auto session =
       create_session(instance, system, vulkan_instance, physicalDevice, device,
                      graphics_queue_family_index);
 
-  Swapchain *swapchains[eyeCount];
-  std::tie(swapchains[0], swapchains[1]) =
-      create_swapchains(instance, system, session);
+  std::vector<Swapchain *> swapchains;
+
+  if (multiview) {
+    swapchains.push_back(create_multiview_swapchain(instance, system, session));
+  } else {
+    const auto [left, right] = create_swapchains(instance, system, session);
+    swapchains = {left, right};
+  }
 
-  std::vector<xr::SwapchainImageVulkanKHR> swapchain_images[eyeCount];
+  std::vector<std::vector<xr::SwapchainImageVulkanKHR>> swapchain_images(
+      swapchains.size());
 
-  for (size_t i = 0; i < eyeCount; i++) {
+  for (size_t i = 0; i < swapchains.size(); i++) {
     swapchain_images[i] =
         swapchains[i]
             ->swapchain
             .enumerateSwapchainImagesToVector<xr::SwapchainImageVulkanKHR>();
   }
 
-  std::vector<SwapchainImage *> wrapped_swapchain_images[eyeCount];
+  std::vector<mov::TransientAttachments> depth_targets(swapchains.size());
 
-  for (size_t i = 0; i < eyeCount; i++) {
+  for (size_t i = 0; i < swapchains.size(); i++) {
+    depth_targets[i] = mov::TransientAttachments(
+        allocator, swapchains[i]->width, swapchains[i]->height, depth_format,
+        vk::ImageAspectFlagBits::eDepth,
+        vk::ImageUsageFlagBits::eDepthStencilAttachment, framesInFlight,
+        swapchains[i]->layers);
+  }
+
+  spdlog::info("Depth attachments: {}, {} per swapchain{}",
+               vk::to_string(depth_format), framesInFlight,
+               depth_targets[0].lazily_allocated() ? ", lazily allocated"
+                                                   : "");
+
+  std::vector<std::vector<SwapchainImage *>> wrapped_swapchain_images(
+      swapchains.size());
+
+  for (size_t i = 0; i < swapchains.size(); i++) {
     wrapped_swapchain_images[i] =
         std::vector<SwapchainImage *>(swapchain_images[i].size(), nullptr);
 
     for (size_t j = 0; j < wrapped_swapchain_images[i].size(); j++) {
-      wrapped_swapchain_images[i][j] = new SwapchainImage(
-          physicalDevice, device, render_pass, command_pool, descriptor_pool,
-          descriptor_set_layout, swapchains[i], swapchain_images[i][j]);
+      wrapped_swapchain_images[i][j] =
+          new SwapchainImage(device, render_pass, swapchains[i],
+                             swapchain_images[i][j], depth_targets[i]);
     }
   }
 
@@ -1336,28 +1935,67 @@ int main(int, char **) {
   attach_action_set(session, action_set);
 
   signal(SIGINT, onInterrupt);
+#if defined SIGUSR1
+  signal(SIGUSR1, onTraceRequest);
+#elif defined SIGBREAK
+  signal(SIGBREAK, onTraceRequest);
+#endif
+
+  if constexpr (mov::tracing_enabled)
+    mov::Tracer::get().set_thread_name("main");
 
   bool running = false;
+  uint64_t frame_count = 0;
   while (!quit) {
+    if (traceRequested) {
+      traceRequested = 0;
+      write_trace();
+    }
+
     xr::EventDataBuffer event_data{};
 
-    if (const auto result = instance.pollEvent(event_data);
-        result == xr::Result::EventUnavailable) {
+    const auto result = [&] {
+      MOV_TRACE_ZONE("pollEvent");
+      return instance.pollEvent(event_data);
+    }();
+
+    if (result == xr::Result::EventUnavailable) {
       if (running) {
-        auto frame_state = session.waitFrame({}, {});
+        MOV_TRACE_ZONE("frame");
+
+        const auto frame_state = [&] {
+          MOV_TRACE_ZONE("waitFrame");
+          return session.waitFrame({}, {});
+        }();
 
         if (!frame_state.shouldRender) {
           continue;
         }
 
-        quit =
-            !input(session, action_set, space, frame_state.predictedDisplayTime,
-                   left_hand_action, right_hand_action, left_grab_action,
-                   right_grab_action, left_hand_space, right_hand_space);
+        {
+          MOV_TRACE_ZONE("input");
+          quit = !input(session, action_set, space,
+                        frame_state.predictedDisplayTime, left_hand_action,
+                        right_hand_action, left_grab_action,
+                        right_grab_action, left_hand_space, right_hand_space);
+        }
+
+        {
+          MOV_TRACE_ZONE("defragment");
+          if (geometry.defragment(frame_count, defragmentBudget) > 0)
+            uploader.flush();
+        }
 
         quit = !render(session, swapchains, wrapped_swapchain_images, space,
-                       frame_state.predictedDisplayTime, device, queue,
-                       render_pass, pipelineLayout, pipeline);
+                       frame_state.predictedDisplayTime, frame_count++, queue,
+                       render_pass, pipelineLayout, pipeline,
+                       instanced_pipeline, descriptor_set,
+                       culled_descriptor_set, meshlet_descriptor_set,
+                       uniforms, instances, culler, meshlet_culler,
+                       frustum_culler, geometry, recorder, static_commands,
+                       scheduler, resolution, profiler);
+
+        memory_budget.update();
       }
     } else if (result != xr::Result::Success) {
       spdlog::error("Failed to poll events: {}", xr::to_string_literal(result));
@@ -1426,6 +2064,9 @@ int main(int, char **) {
     spdlog::error("Failed to wait for device to idle: {}", result);
   }
 
+  if (writeTraceOnExit)
+    write_trace();
+
   left_hand_space.destroy();
   right_hand_space.destroy();
 
@@ -1444,6 +2085,9 @@ int main(int, char **) {
     }
   }
 
+  for (auto &depth_target : depth_targets)
+    depth_target.destroy();
+
   for (const auto &swapchain : swapchains) {
     delete swapchain;
   }
@@ -1451,14 +2095,131 @@ int main(int, char **) {
   session.destroy();
 
   object.destroy();
+  controller.destroy();
+  quad.destroy();
+
+  spdlog::info("Geometry defragmenter moved {} bytes",
+               geometry.stats().defragmented);
+
+  const auto instance_stats = instances.stats();
+  spdlog::info("Instancing: {} objects in {} draw calls, {} fewer than one "
+               "draw per object",
+               instance_stats.instances, instance_stats.draws,
+               instance_stats.instances - instance_stats.draws);
+
+  const auto record_stats = recorder.stats();
+  spdlog::info("Recording: {} draws in {} secondary command buffers on up to "
+               "{} threads, {:.1f} us per pass",
+               record_stats.items, record_stats.slices,
+               recorder.worker_count(),
+               record_stats.microseconds_per_recording());
+
+  const auto frame_stats = scheduler.stats();
+  spdlog::info("Frames: {} submitted with {} command buffers, waited {:.2f} "
+               "ms per frame for the GPU (worst {:.2f} ms)",
+               frame_stats.frames, frame_stats.command_buffers,
+               frame_stats.average_gpu_wait_ms(),
+               std::chrono::duration<double, std::milli>(
+                   frame_stats.max_gpu_wait)
+                   .count());
+
+  if (frame_stats.timed_frames > 0)
+    spdlog::info("GPU time: {:.2f} ms per frame over {} timed frames",
+                 frame_stats.average_gpu_time_ms(), frame_stats.timed_frames);
+
+  if (dynamicResolution) {
+    const auto resolution_stats = resolution.stats();
+    spdlog::info("Dynamic resolution: scale {:.2f} (lowest {:.2f}), {} "
+                 "shrinks and {} grows over {} frames, {} stale frames "
+                 "skipped",
+                 resolution.scale(), resolution_stats.min_scale,
+                 resolution_stats.shrinks, resolution_stats.grows,
+                 resolution_stats.samples, resolution_stats.skipped);
+  }
+
+  for (const auto &[name, timing] : profiler.report())
+    if (timing.samples > 0)
+      spdlog::info("GPU {}: {:.3f} ms average, {:.3f} ms min, {:.3f} ms p99 "
+                   "over {} frames",
+                   name, timing.average_ms, timing.min_ms, timing.p99_ms,
+                   timing.samples);
+
+  const auto static_stats = static_commands.stats();
+  spdlog::info("Static commands: {} cache hits, {} re-recorded",
+               static_stats.hits, static_stats.records);
+
+  const auto frustum_cull_stats = frustum_culler.stats();
+  spdlog::info("CPU culling: {} of {} objects visible, {:.1f} objects per "
+               "microsecond",
+               frustum_cull_stats.visible, frustum_cull_stats.tested,
+               frustum_cull_stats.objects_per_microsecond());
+
+  const auto cull_stats = culler.stats();
+  spdlog::info("GPU culling: {} objects over {} dispatches{}",
+               cull_stats.objects, cull_stats.dispatches,
+               cull_stats.verified_frames > 0
+                   ? fmt::format(", {} of {} verified frames mismatched",
+                                 cull_stats.mismatched_frames,
+                                 cull_stats.verified_frames)
+                   : "");
+
+  const auto meshlet_stats = meshlet_culler.stats();
+  spdlog::info("Meshlet culling: {} meshlets over {} dispatches{}",
+               meshlet_stats.objects, meshlet_stats.dispatches,
+               meshlet_stats.verified_frames > 0
+                   ? fmt::format(", {} of {} verified frames mismatched",
+                                 meshlet_stats.mismatched_frames,
+                                 meshlet_stats.verified_frames)
+                   : "");
+
+  crowd.clear();
+
+  geometry.destroy();
+  instances.destroy();
+  culler.destroy();
+  meshlet_culler.destroy();
+  recorder.destroy();
+  static_commands.destroy();
+  scheduler.destroy();
+  profiler.destroy();
+  uniforms.destroy();
+
+  const auto upload_stats = uploader.stats();
+  spdlog::info("Uploaded {} bytes in {} copies over {} batches at {:.1f} MB/s",
+               upload_stats.bytes, upload_stats.copies, upload_stats.batches,
+               upload_stats.megabytes_per_second());
+
+  const auto &memory_report = memory_budget.update();
+  for (uint32_t i = 0; i < memory_report.heaps.size(); i++) {
+    const auto &heap = memory_report.heaps[i];
+    spdlog::info("Memory heap {}{}: high water {} / {} bytes ({})", i,
+                 heap.device_local ? " (device local)" : "", heap.high_water,
+                 heap.budget,
+                 memory_report.from_driver ? "driver" : "estimate");
+  }
+
+  for (uint32_t i = 0; i < mov::memory_category_count; i++)
+    spdlog::info("Memory category {}: high water {} bytes",
+                 mov::to_string(static_cast<mov::MemoryCategory>(i)),
+                 memory_report.category_high_water[i]);
+
+  uploader.destroy();
+  allocator.destroy();
+
+  if (!pipeline_cache.save())
+    spdlog::warn("Failed to write the pipeline cache to {}",
+                 pipelineCachePath);
+  pipeline_cache.destroy();
+
+  const auto variant_stats = pipelines.stats();
+  spdlog::info("Pipeline variants: {} created for {} lookups",
+               variant_stats.variants, variant_stats.lookups);
 
-  device.destroyPipeline(pipeline);
+  pipelines.destroy();
   device.destroyPipelineLayout(pipelineLayout);
-  device.destroyShaderModule(fragment_shader);
-  device.destroyShaderModule(vertex_shader);
+  device.destroyShaderModule(cull_shader);
   device.destroyDescriptorSetLayout(descriptor_set_layout);
   device.destroyDescriptorPool(descriptor_pool);
-  device.destroyCommandPool(command_pool);
   device.destroyRenderPass(render_pass);
 
   device.destroy();
@@ -9,4 +9,24 @@ void Controller::draw(const vk::CommandBuffer commands,
   GameObject::draw(commands, pipeline, transform.matrix() * custom_origin_);
 }
 
+void Controller::batch(InstanceBatcher &batcher) {
+  GameObject::batch(batcher, transform.matrix() * custom_origin_);
+}
+
+void Controller::submit(GpuCuller &culler) {
+  GameObject::submit(culler, transform.matrix() * custom_origin_);
+}
+
+void Controller::select_lod(const LodView &view) {
+  GameObject::select_lod(view, transform.matrix() * custom_origin_);
+}
+
+auto Controller::bounding_sphere() -> BoundingSphere {
+  return GameObject::bounding_sphere(transform.matrix() * custom_origin_);
+}
+
+auto Controller::bounding_box() -> BoundingBox {
+  return GameObject::bounding_box(transform.matrix() * custom_origin_);
+}
+
 }; // namespace mov::core
\ No newline at end of file
@@ -9,7 +9,7 @@ class Controller final : public GameObject {
 public:
   Controller() = default;
 
-  Controller(const mov::Mesh &mesh)
+  Controller(const mov::LodChain &mesh)
       : GameObject(mesh), custom_origin_(glm::identity<glm::mat4>()) {
     custom_origin_ =
         glm::translate(glm::rotate(glm::identity<glm::mat4>(),
@@ -19,6 +19,11 @@ public:
   }
 
   void draw(vk::CommandBuffer, vk::PipelineLayout) override;
+  void batch(InstanceBatcher &) override;
+  void submit(GpuCuller &) override;
+  void select_lod(const LodView &) override;
+  auto bounding_sphere() -> BoundingSphere override;
+  auto bounding_box() -> BoundingBox override;
 
   ~Controller() override = default;
 
@@ -0,0 +1,51 @@
+#include "MeshImport.hpp"
+
+#include <glm/glm.hpp>
+
+namespace mov::core {
+
+auto import_mesh(const aiMesh *mesh) -> ImportedMesh {
+  ImportedMesh imported;
+  auto &[vertices, indices] = imported;
+
+  for (auto i = 0u; i < mesh->mNumVertices; ++i) {
+    VertexAttributes vertex;
+
+    vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y,
+                                mesh->mVertices[i].z);
+
+    if (mesh->mTextureCoords[0])
+      vertex.uv = glm::vec2(mesh->mTextureCoords[0][i].x,
+                            mesh->mTextureCoords[0][i].y);
+
+    vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y,
+                              mesh->mNormals[i].z);
+
+    if (mesh->mTangents) {
+      const glm::vec3 tangent(mesh->mTangents[i].x, mesh->mTangents[i].y,
+                              mesh->mTangents[i].z);
+      const glm::vec3 bitangent(mesh->mBitangents[i].x,
+                                mesh->mBitangents[i].y,
+                                mesh->mBitangents[i].z);
+
+      vertex.tangent = glm::vec4(
+          tangent,
+          glm::dot(glm::cross(vertex.normal, tangent), bitangent) < 0.f ? -1.f
+                                                                       : 1.f);
+    }
+
+    vertex.color = glm::vec3(1.0);
+
+    vertices.push_back(vertex);
+  }
+
+  for (auto i = 0u; i < mesh->mNumFaces; ++i) {
+    const auto face = mesh->mFaces[i];
+    for (auto j = 0u; j < face.mNumIndices; ++j)
+      indices.push_back(face.mIndices[j]);
+  }
+
+  return imported;
+}
+
+}; // namespace mov::core
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <mov/PackedVertex.hpp>
+
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <vector>
+
+namespace mov::core {
+
+struct ImportedMesh {
+  std::vector<VertexAttributes> vertices;
+  std::vector<unsigned int> indices;
+};
+
+inline constexpr auto importFlags =
+    aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+    aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices |
+    aiProcess_SortByPType;
+
+// Copies an assimp mesh imported with importFlags into vertex attributes
+// and a triangle list.
+auto import_mesh(const aiMesh *mesh) -> ImportedMesh;
+
+}; // namespace mov::core
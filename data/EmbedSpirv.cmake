@@ -0,0 +1,29 @@
+# Writes a SPIR-V binary out as a header holding it as a constexpr uint32_t
+# array, so shader modules can be created without reading files.
+#
+# cmake -DINPUT=<file.spv> -DOUTPUT=<file.hpp> -DIDENTIFIER=<name>
+#       -P EmbedSpirv.cmake
+
+file(READ ${INPUT} contents HEX)
+
+# SPIR-V is a stream of little-endian words.
+string(REGEX REPLACE
+  "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+  "0x\\4\\3\\2\\1, " words "${contents}")
+string(REPEAT "0x[0-9a-f]+, " 5 row)
+string(REGEX REPLACE "(${row}0x[0-9a-f]+,) " "\\1\n    " words "${words}")
+string(STRIP "${words}" words)
+
+file(WRITE ${OUTPUT}
+"// Generated from ${INPUT} by EmbedSpirv.cmake; do not edit.
+#pragma once
+
+#include <cstdint>
+
+namespace mov::shaders {
+
+inline constexpr uint32_t ${IDENTIFIER}[] = {
+    ${words}};
+
+} // namespace mov::shaders
+")
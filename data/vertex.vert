@@ -1,22 +1,45 @@
 #version 450
 #extension GL_KHR_vulkan_glsl: enable
 
+// Built twice: as is for the single-pass multiview path, and with
+// SINGLE_VIEW defined for the two-pass fallback, which draws one eye at a
+// time from slot 0.
+#ifdef SINGLE_VIEW
+#define VIEW_INDEX 0
+#else
+#extension GL_EXT_multiview: enable
+#define VIEW_INDEX gl_ViewIndex
+#endif
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 color;
 
 layout(binding = 0) uniform Matrices {
-    mat4 projection;
-    mat4 view;
+    mat4 projection[2];
+    mat4 view[2];
 } matrices;
 
+layout(std430, binding = 1) readonly buffer Instances {
+    mat4 model[];
+} instances;
+
 layout(push_constant) uniform constants {
     mat4 model;
 } PushConstants;
 
+// Instanced pipelines read the model matrix per instance instead of from
+// push constants.
+layout(constant_id = 0) const bool instanced = false;
+
+// Without vertex colors everything is drawn white.
+layout(constant_id = 1) const bool vertexColor = true;
+
 void main()
 {
-    gl_Position = matrices.projection * matrices.view * PushConstants.model * vec4(inPosition, 1);
-    color = inColor;
+    mat4 model = instanced ? instances.model[gl_InstanceIndex] : PushConstants.model;
+
+    gl_Position = matrices.projection[VIEW_INDEX] * matrices.view[VIEW_INDEX] * model * vec4(inPosition, 1);
+    color = vertexColor ? inColor : vec3(1);
 }
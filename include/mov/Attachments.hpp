@@ -0,0 +1,57 @@
+#pragma once
+
+#include <mov/VkAllocator.hpp>
+#include <mov/VkImage.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+namespace mov {
+
+// Picks the smallest depth format whose step size at the far plane stays
+// within `tolerance` of the distance there, for a [0, 1] perspective depth.
+extern vk::Format find_depth_format(vk::PhysicalDevice physical_device,
+                                    float near_distance, float far_distance,
+                                    float tolerance = 0.01f);
+
+// Attachments that are never read outside the render pass that writes them.
+// They are created TRANSIENT so tilers can back them with lazily allocated
+// memory, and there is one image per frame in flight instead of one per
+// swapchain image.
+class TransientAttachments {
+public:
+  TransientAttachments() = default;
+
+  TransientAttachments(VkAllocator &allocator, uint32_t width, uint32_t height,
+                       vk::Format format, vk::ImageAspectFlags aspect,
+                       vk::ImageUsageFlags usage, uint32_t count,
+                       uint32_t layers = 1);
+
+  TransientAttachments(const TransientAttachments &other) = delete;
+  TransientAttachments(TransientAttachments &&other) = delete;
+  TransientAttachments &operator=(const TransientAttachments &other) = delete;
+  TransientAttachments &operator=(TransientAttachments &&other) = default;
+
+  ~TransientAttachments() = default;
+
+  [[nodiscard]] auto operator[](const uint32_t slot) const -> const VkImage & {
+    return images_[slot];
+  }
+
+  [[nodiscard]] auto count() const {
+    return static_cast<uint32_t>(images_.size());
+  }
+  [[nodiscard]] auto format() const { return format_; }
+  [[nodiscard]] auto lazily_allocated() const { return lazily_allocated_; }
+
+  void destroy();
+
+private:
+  vk::Format format_{vk::Format::eUndefined};
+  bool lazily_allocated_{false};
+
+  std::vector<VkImage> images_;
+};
+
+} // namespace mov
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <mov/PackedVertex.hpp>
+#include <mov/Vertex.hpp>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+namespace mov {
+
+struct BoundingSphere {
+  glm::vec3 center{0.f};
+  float radius{0.f};
+
+  // Bounds of the sphere after `model`, scaled by its largest axis.
+  [[nodiscard]] auto transformed(const glm::mat4 &model) const {
+    const auto scale = glm::max(glm::length(glm::vec3(model[0])),
+                                glm::max(glm::length(glm::vec3(model[1])),
+                                         glm::length(glm::vec3(model[2]))));
+
+    return BoundingSphere{glm::vec3(model * glm::vec4(center, 1.f)),
+                          radius * scale};
+  }
+};
+
+struct BoundingBox {
+  glm::vec3 min{0.f};
+  glm::vec3 max{0.f};
+
+  [[nodiscard]] auto center() const { return (min + max) * 0.5f; }
+  [[nodiscard]] auto extent() const { return (max - min) * 0.5f; }
+
+  // Box around the eight transformed corners.
+  [[nodiscard]] auto transformed(const glm::mat4 &model) const -> BoundingBox;
+
+  // Encloses the box, so it is never tighter than one computed from the
+  // vertices directly.
+  [[nodiscard]] auto sphere() const {
+    return BoundingSphere{center(), glm::length(extent())};
+  }
+};
+
+extern BoundingBox compute_bounding_box(const std::vector<Vertex> &vertices);
+extern BoundingBox
+compute_bounding_box(const std::vector<VertexAttributes> &vertices);
+
+// Centred on the box around the vertices, which is cheap and at most ~1.7x
+// the size of the optimal sphere.
+extern BoundingSphere
+compute_bounding_sphere(const std::vector<Vertex> &vertices);
+extern BoundingSphere
+compute_bounding_sphere(const std::vector<VertexAttributes> &vertices);
+
+// Planes point inwards and are normalised; the order is left, right,
+// bottom, top, near, far.
+struct Frustum {
+  std::array<glm::vec4, 6> planes{};
+
+  // For a Vulkan style [0, 1] depth range projection.
+  static auto from_matrix(const glm::mat4 &view_projection) -> Frustum;
+
+  [[nodiscard]] auto intersects(const BoundingSphere &sphere) const -> bool;
+};
+
+} // namespace mov
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <unordered_map>
+
+namespace mov {
+
+struct CommandCacheStats {
+  uint64_t hits{0};
+  uint64_t records{0};
+};
+
+// Everything a cached recording depends on besides the per-frame uniform
+// data. content_version is bumped by the owner whenever the cached set of
+// objects changes; extent is the rendered area the viewport covers, and
+// draw_count the number of draws the recording issues. Only record what
+// reads everything else from buffers: anything written into the commands
+// themselves, such as push constants or mesh offsets, goes stale.
+struct CommandCacheKey {
+  vk::Framebuffer framebuffer;
+  vk::Pipeline pipeline;
+  uint32_t uniform_offset{0};
+  uint64_t content_version{0};
+  vk::Extent2D extent;
+  uint32_t draw_count{0};
+
+  bool operator==(const CommandCacheKey &other) const = default;
+};
+
+// Reusable secondary command buffers for content that rarely changes, one
+// per framebuffer. A buffer is recorded once and executed every frame until
+// its key changes. The buffers must not be in use by the GPU when they are
+// re-recorded, which holds as long as a framebuffer is not reused before
+// the frame that last used it has finished.
+class CommandCache {
+public:
+  using Record = std::function<void(vk::CommandBuffer)>;
+
+  CommandCache(vk::Device device, uint32_t queue_family_index);
+
+  CommandCache(const CommandCache &other) = delete;
+  CommandCache(CommandCache &&other) = delete;
+  CommandCache &operator=(const CommandCache &other) = delete;
+  CommandCache &operator=(CommandCache &&other) = delete;
+
+  ~CommandCache() = default;
+
+  // Starts a new frame's hit and record counters.
+  void begin_frame();
+
+  // Returns the framebuffer's buffer, re-recorded with `record` first if it
+  // was recorded under a different key.
+  auto get(const CommandCacheKey &key,
+           const vk::CommandBufferInheritanceInfo &inheritance,
+           const Record &record) -> vk::CommandBuffer;
+
+  // Drops every recording; needed when framebuffers are destroyed, since
+  // their handles may be reused.
+  void invalidate();
+
+  [[nodiscard]] auto stats() const { return stats_; }
+  [[nodiscard]] auto frame_stats() const { return frame_stats_; }
+
+  void destroy();
+
+private:
+  struct Entry {
+    vk::CommandBuffer commands;
+    CommandCacheKey key;
+    bool recorded{false};
+  };
+
+  vk::Device device_;
+  vk::CommandPool command_pool_;
+
+  std::unordered_map<VkFramebuffer, Entry> entries_;
+
+  CommandCacheStats stats_;
+  CommandCacheStats frame_stats_;
+};
+
+} // namespace mov
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace mov {
+
+struct DynamicResolutionSettings {
+  // GPU time a frame may take; below the display's frame interval to leave
+  // room for the compositor.
+  std::chrono::duration<float, std::milli> target{9.f};
+
+  // Bounds of the scale applied to both axes of the recommended size.
+  float min_scale{0.6f};
+  float max_scale{1.f};
+
+  // Frames within this fraction of the target leave the scale alone, so it
+  // does not oscillate around the target.
+  float hysteresis{0.1f};
+
+  // Growth per measured frame once there is headroom. Shrinking is
+  // proportional to the overshoot instead, so a spike is absorbed within a
+  // frame or two.
+  float grow_step{0.02f};
+
+  // Frames kept in history().
+  uint32_t history_size{512};
+};
+
+struct DynamicResolutionSample {
+  std::chrono::duration<float, std::milli> gpu_time;
+  // Scale chosen after seeing gpu_time.
+  float scale;
+};
+
+struct DynamicResolutionStats {
+  uint64_t samples{0};
+  // Measurements of frames rendered at an earlier scale, which were ignored.
+  uint64_t skipped{0};
+  uint64_t shrinks{0};
+  uint64_t grows{0};
+  float min_scale{1.f};
+};
+
+// Picks the fraction of each eye's swapchain image to render to from the
+// measured GPU time of recent frames. The rendered area is the top-left
+// extent(...) of the image, which the compositor is told about through the
+// projection view's image rect.
+class DynamicResolution {
+public:
+  // frame_count is the number of frames in flight, each with its own slot.
+  explicit DynamicResolution(const DynamicResolutionSettings &settings = {},
+                             uint32_t frame_count = 1);
+
+  // Called as a slot's frame begins, with the GPU time of the frame that
+  // last used the slot (0 if it was not timed); returns the scale to render
+  // the new frame with. That time is frame_count frames old, so it is only
+  // acted on if the frame was rendered at the current scale: otherwise one
+  // spike would shrink the scale once for every frame already in flight.
+  auto update(uint32_t slot, std::chrono::nanoseconds gpu_time) -> float;
+
+  [[nodiscard]] auto scale() const { return scale_; }
+
+  // The region of a width x height image to render to, never empty.
+  [[nodiscard]] auto extent(uint32_t width, uint32_t height) const
+      -> vk::Extent2D;
+
+  // Oldest first.
+  [[nodiscard]] auto history() const
+      -> const std::deque<DynamicResolutionSample> & {
+    return history_;
+  }
+  [[nodiscard]] auto stats() const { return stats_; }
+
+private:
+  DynamicResolutionSettings settings_;
+  float scale_;
+  // The scale each slot's last frame was rendered at.
+  std::vector<float> slot_scales_;
+
+  std::deque<DynamicResolutionSample> history_;
+  DynamicResolutionStats stats_;
+};
+
+} // namespace mov
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace mov {
+
+struct FrameStats {
+  uint64_t frames{0};
+  uint64_t command_buffers{0};
+
+  // Time the CPU spent blocked on the GPU before it could reuse a slot.
+  std::chrono::nanoseconds gpu_wait{0};
+  std::chrono::nanoseconds max_gpu_wait{0};
+
+  // Time the GPU spent executing the frames that were timed.
+  uint64_t timed_frames{0};
+  std::chrono::nanoseconds gpu_time{0};
+
+  [[nodiscard]] auto average_gpu_wait_ms() const {
+    return frames > 0 ? std::chrono::duration<double, std::milli>(gpu_wait)
+                                .count() /
+                            static_cast<double>(frames)
+                      : 0.;
+  }
+
+  [[nodiscard]] auto average_gpu_time_ms() const {
+    return timed_frames > 0
+               ? std::chrono::duration<double, std::milli>(gpu_time).count() /
+                     static_cast<double>(timed_frames)
+               : 0.;
+  }
+};
+
+// Paces the CPU against the GPU with a fence per frame in flight. Each slot
+// owns a command pool that is reset as a whole when the slot comes round
+// again, and everything recorded for a frame goes to the queue in a single
+// submit. Given the device's timestamp period, each submit is bracketed by
+// timestamps so the GPU time of a frame is known once its slot comes round.
+class FrameScheduler {
+public:
+  // A timestamp_period of 0 leaves frames untimed, for queues without
+  // timestamp support.
+  FrameScheduler(vk::Device device, uint32_t queue_family_index,
+                 uint32_t frame_count, float timestamp_period = 0.f);
+
+  FrameScheduler(const FrameScheduler &other) = delete;
+  FrameScheduler(FrameScheduler &&other) = delete;
+  FrameScheduler &operator=(const FrameScheduler &other) = delete;
+  FrameScheduler &operator=(FrameScheduler &&other) = delete;
+
+  ~FrameScheduler() = default;
+
+  // Blocks until the GPU has finished the last frame that used this slot,
+  // then reads its GPU time and recycles its command buffers. Returns the
+  // slot, which every other per-frame resource may then be reused for.
+  auto begin_frame(uint64_t frame) -> uint32_t;
+
+  // A primary command buffer from the current slot's pool. It is appended to
+  // this frame's submit in the order it was handed out.
+  auto command_buffer() -> vk::CommandBuffer;
+
+  // Submits this frame's command buffers, signalling the slot's fence.
+  void submit(vk::Queue queue);
+
+  [[nodiscard]] auto slot() const { return slot_; }
+  [[nodiscard]] auto last_gpu_wait() const { return last_gpu_wait_; }
+  // GPU time of the frame that last used the current slot, frame_count
+  // frames ago; 0 if that frame was not timed.
+  [[nodiscard]] auto last_gpu_time() const { return last_gpu_time_; }
+  [[nodiscard]] auto timing() const { return timestamp_period_ > 0.f; }
+  [[nodiscard]] auto stats() const { return stats_; }
+
+  void destroy();
+
+private:
+  struct Frame {
+    vk::CommandPool pool;
+    vk::Fence fence;
+    std::vector<vk::CommandBuffer> buffers;
+    uint32_t used{0};
+    bool timed{false};
+  };
+
+  vk::Device device_;
+  float timestamp_period_;
+  vk::QueryPool query_pool_;
+
+  std::vector<Frame> frames_;
+  uint32_t slot_{0};
+
+  std::chrono::nanoseconds last_gpu_wait_{0};
+  std::chrono::nanoseconds last_gpu_time_{0};
+  FrameStats stats_;
+};
+
+} // namespace mov
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace mov {
+
+class FreeList {
+public:
+  using Size = uint64_t;
+
+  FreeList() = default;
+
+  explicit FreeList(const Size capacity)
+      : capacity_(capacity), free_({{0, capacity}}) {}
+
+  [[nodiscard]] auto allocate(Size size, Size alignment = 1)
+      -> std::optional<Size>;
+
+  // First fit from offset zero, restricted to ranges ending at or before
+  // `limit`; used to pull allocations towards the start when compacting.
+  [[nodiscard]] auto allocate_below(Size limit, Size size, Size alignment = 1)
+      -> std::optional<Size>;
+
+  void free(Size offset, Size size);
+
+  [[nodiscard]] auto capacity() const { return capacity_; }
+  [[nodiscard]] auto used() const { return used_; }
+  [[nodiscard]] auto empty() const { return used_ == 0; }
+
+  [[nodiscard]] auto largest_free() const -> Size;
+  [[nodiscard]] auto free_range_count() const {
+    return static_cast<uint32_t>(free_.size());
+  }
+
+  static constexpr auto align_up(const Size value, const Size alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment
+                         : value;
+  }
+
+private:
+  struct Range {
+    Size offset;
+    Size size;
+  };
+
+  auto take(std::vector<Range>::iterator it, Size size, Size alignment)
+      -> Size;
+
+  Size capacity_{0};
+  Size used_{0};
+
+  std::vector<Range> free_;
+};
+
+} // namespace mov
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mov/Bounds.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace mov {
+
+struct FrustumCullStats {
+  uint64_t tested{0};
+  uint64_t visible{0};
+
+  std::chrono::nanoseconds busy{0};
+
+  [[nodiscard]] auto objects_per_microsecond() const {
+    const auto microseconds =
+        std::chrono::duration<double, std::micro>(busy).count();
+    return microseconds > 0 ? static_cast<double>(tested) / microseconds : 0.;
+  }
+};
+
+// Tests world space bounding spheres against one or more frusta on the CPU,
+// lane_count spheres at a time. The spheres are stored as separate x, y, z
+// and radius arrays so one load fills a register with the same component of
+// consecutive spheres.
+class FrustumCuller {
+public:
+  static constexpr uint32_t lane_count = 4;
+
+  FrustumCuller() = default;
+
+  FrustumCuller(const FrustumCuller &other) = delete;
+  FrustumCuller(FrustumCuller &&other) = delete;
+  FrustumCuller &operator=(const FrustumCuller &other) = delete;
+  FrustumCuller &operator=(FrustumCuller &&other) = delete;
+
+  ~FrustumCuller() = default;
+
+  void clear();
+
+  // Returns the index the sphere is reported under by cull().
+  auto add(const BoundingSphere &sphere) -> uint32_t;
+
+  // Appends, in ascending order, the index of every sphere that intersects
+  // at least one of the frusta.
+  void cull(const Frustum *frusta, uint32_t frustum_count,
+            std::vector<uint32_t> &visible);
+
+  [[nodiscard]] auto size() const { return count_; }
+  [[nodiscard]] auto stats() const { return stats_; }
+
+private:
+  // Padded to a whole number of lanes; padding lanes are never reported.
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> z_;
+  std::vector<float> radius_;
+
+  uint32_t count_{0};
+
+  FrustumCullStats stats_;
+};
+
+} // namespace mov
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <mov/GpuCuller.hpp>
+#include <mov/InstanceBatcher.hpp>
+#include <mov/LodChain.hpp>
 #include <mov/Mesh.hpp>
 #include <mov/Transform.hpp>
 
@@ -12,20 +15,48 @@ public:
   GameObject() = default;
   virtual ~GameObject() = default;
 
-  GameObject(const Mesh &mesh)
-      : transform(Transform::identity()), meshes_(std::vector<Mesh>()) {
+  GameObject(const Mesh &mesh) : GameObject(LodChain(mesh)) {}
+
+  GameObject(const LodChain &mesh)
+      : transform(Transform::identity()), meshes_(std::vector<LodChain>()),
+        bounds_(mesh.current().bounding_sphere()),
+        box_(mesh.current().bounding_box()) {
     meshes_.push_back(mesh);
   }
 
   virtual void draw(vk::CommandBuffer, vk::PipelineLayout);
   virtual void draw(vk::CommandBuffer, vk::PipelineLayout, glm::mat4);
 
+  // Queues the meshes on an instance batcher instead of drawing them with
+  // push constants.
+  virtual void batch(InstanceBatcher &);
+  virtual void batch(InstanceBatcher &, glm::mat4);
+
+  // Hands the meshes to the GPU culler, which draws the visible ones.
+  virtual void submit(GpuCuller &);
+  virtual void submit(GpuCuller &, glm::mat4);
+
+  // Picks the level of detail the meshes are drawn, batched and submitted
+  // with until the next call.
+  virtual void select_lod(const LodView &);
+  virtual void select_lod(const LodView &, glm::mat4);
+
+  // World space bounds of all meshes, for culling.
+  virtual auto bounding_sphere() -> BoundingSphere;
+  [[nodiscard]] auto bounding_sphere(glm::mat4) const -> BoundingSphere;
+  // The box around the transformed corners of the meshes' boxes, which is
+  // tighter than the sphere for long, thin objects.
+  virtual auto bounding_box() -> BoundingBox;
+  [[nodiscard]] auto bounding_box(glm::mat4) const -> BoundingBox;
+
   virtual void destroy();
 
   Transform transform;
 
 private:
-  std::vector<Mesh> meshes_;
+  std::vector<LodChain> meshes_;
+  BoundingSphere bounds_;
+  BoundingBox box_;
 };
 
 }; // namespace mov
\ No newline at end of file
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <mov/FreeList.hpp>
+#include <mov/PackedVertex.hpp>
+#include <mov/Vertex.hpp>
+#include <mov/VkBuffer.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <type_traits>
+#include <vector>
+
+namespace mov {
+
+// first_index counts indices of index_type from the start of the pool's
+// index buffer.
+struct GeometryDraw {
+  uint32_t index_count{0};
+  uint32_t first_index{0};
+  int32_t vertex_offset{0};
+  vk::IndexType index_type{vk::IndexType::eUint32};
+};
+
+[[nodiscard]] constexpr auto index_size(const vk::IndexType index_type)
+    -> uint32_t {
+  return index_type == vk::IndexType::eUint16 ? sizeof(uint16_t)
+                                              : sizeof(uint32_t);
+}
+
+struct GeometryStats {
+  uint32_t allocation_count{0};
+
+  vk::DeviceSize vertex_capacity{0};
+  vk::DeviceSize vertex_used{0};
+  vk::DeviceSize vertex_largest_free{0};
+
+  vk::DeviceSize index_capacity{0};
+  vk::DeviceSize index_used{0};
+  vk::DeviceSize index_largest_free{0};
+
+  // Freed or vacated ranges waiting for in-flight frames to finish, and the
+  // total number of bytes the defragmenter has moved so far.
+  vk::DeviceSize retired{0};
+  vk::DeviceSize defragmented{0};
+
+  [[nodiscard]] auto vertex_occupancy() const {
+    return static_cast<float>(vertex_used) /
+           static_cast<float>(vertex_capacity);
+  }
+
+  [[nodiscard]] auto index_occupancy() const {
+    return static_cast<float>(index_used) / static_cast<float>(index_capacity);
+  }
+};
+
+class GeometryPool {
+public:
+  using Handle = uint32_t;
+
+  static constexpr Handle invalid_handle = ~0u;
+
+  static constexpr vk::DeviceSize default_vertex_capacity =
+      64ull * 1024 * 1024;
+  static constexpr vk::DeviceSize default_index_capacity = 32ull * 1024 * 1024;
+  static constexpr uint32_t default_frame_latency = 3;
+
+  // Freed ranges are only handed out again `frame_latency` frames later, so
+  // it must cover every frame the GPU may still be reading from.
+  GeometryPool(VkBufferProvider provider,
+               vk::DeviceSize vertex_capacity = default_vertex_capacity,
+               vk::DeviceSize index_capacity = default_index_capacity,
+               uint32_t frame_latency = default_frame_latency);
+
+  GeometryPool(const GeometryPool &other) = delete;
+  GeometryPool(GeometryPool &&other) = delete;
+  GeometryPool &operator=(const GeometryPool &other) = delete;
+  GeometryPool &operator=(GeometryPool &&other) = delete;
+
+  ~GeometryPool() = default;
+
+  // Indices are eUint16 or eUint32; 16-bit ranges are only 2-byte aligned,
+  // so both kinds share the one index buffer.
+  [[nodiscard]] auto allocate(const void *vertices, uint32_t vertex_count,
+                              uint32_t vertex_stride, const void *indices,
+                              uint32_t index_count,
+                              vk::IndexType index_type = vk::IndexType::eUint32)
+      -> Handle;
+
+  template <typename V, typename I>
+  [[nodiscard]] auto allocate(const std::vector<V> &vertices,
+                              const std::vector<I> &indices) {
+    static_assert(std::is_same_v<I, uint16_t> || std::is_same_v<I, uint32_t>);
+
+    return allocate(vertices.data(), static_cast<uint32_t>(vertices.size()),
+                    sizeof(V), indices.data(),
+                    static_cast<uint32_t>(indices.size()),
+                    sizeof(I) == sizeof(uint16_t) ? vk::IndexType::eUint16
+                                                  : vk::IndexType::eUint32);
+  }
+
+  void free(Handle handle);
+
+  // Called once per frame: releases retired ranges and moves up to
+  // byte_budget bytes of live geometry towards the start of the buffers.
+  // The copies go through the uploader, so flush it before recording draws.
+  auto defragment(uint64_t frame, vk::DeviceSize byte_budget)
+      -> vk::DeviceSize;
+
+  // Binds the vertex buffer and the index buffer as eUint32, which every
+  // draw expects unless it binds another index type itself.
+  void bind(vk::CommandBuffer command_buffer) const;
+
+  // Rebinds just the index buffer, to draw ranges of another index type.
+  void bind_indices(vk::CommandBuffer command_buffer,
+                    vk::IndexType index_type) const;
+
+  [[nodiscard]] auto draw(const Handle handle) const {
+    const auto &entry = entries_[handle];
+
+    return GeometryDraw{
+        entry.index_count,
+        static_cast<uint32_t>(entry.index_offset /
+                              index_size(entry.index_type)),
+        static_cast<int32_t>(entry.vertex_offset / entry.vertex_stride),
+        entry.index_type};
+  }
+
+  [[nodiscard]] auto stats() const -> GeometryStats;
+
+  void destroy();
+
+private:
+  struct Entry {
+    vk::DeviceSize vertex_offset{0};
+    vk::DeviceSize vertex_size{0};
+    uint32_t vertex_stride{0};
+
+    vk::DeviceSize index_offset{0};
+    vk::DeviceSize index_size{0};
+    uint32_t index_count{0};
+    vk::IndexType index_type{vk::IndexType::eUint32};
+
+    bool live{false};
+  };
+
+  struct Retired {
+    vk::DeviceSize offset;
+    vk::DeviceSize size;
+    bool vertex;
+    uint64_t frame;
+  };
+
+  void retire(bool vertex, vk::DeviceSize offset, vk::DeviceSize size);
+  auto compact(bool vertex, vk::DeviceSize byte_budget) -> vk::DeviceSize;
+
+  VkBufferProvider provider_;
+
+  vk::Buffer vertex_buffer_;
+  VkAllocation vertex_allocation_;
+  FreeList vertex_ranges_;
+
+  vk::Buffer index_buffer_;
+  VkAllocation index_allocation_;
+  FreeList index_ranges_;
+
+  std::vector<Entry> entries_;
+  std::vector<Handle> free_handles_;
+
+  uint32_t frame_latency_;
+  uint64_t frame_{0};
+  std::vector<Retired> retired_;
+
+  vk::DeviceSize defragmented_{0};
+};
+
+} // namespace mov
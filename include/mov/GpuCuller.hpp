@@ -0,0 +1,155 @@
+#pragma once
+
+#include <mov/Bounds.hpp>
+#include <mov/Mesh.hpp>
+#include <mov/PipelineCache.hpp>
+#include <mov/VkAllocator.hpp>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include <vector>
+
+namespace mov {
+
+struct CullStats {
+  uint64_t objects{0};
+  uint64_t dispatches{0};
+
+  uint64_t verified_frames{0};
+  uint64_t mismatched_frames{0};
+};
+
+// Frustum culls objects in a compute pass and draws the survivors with
+// indirect draws, so recording the scene costs the same for any object
+// count. Visible objects are compacted with drawIndexedIndirectCount when
+// the device has it; otherwise culled commands get an instance count of 0.
+// Model matrices of the drawn commands land in instance_buffer(), indexed by
+// gl_InstanceIndex like the InstanceBatcher's. Meshes split into meshlets
+// are culled one meshlet at a time, and meshlets whose normal cone faces
+// away from every view are dropped as well.
+class GpuCuller {
+public:
+  static constexpr uint32_t default_frame_capacity = 16 * 1024;
+  static constexpr uint32_t max_views = 2;
+
+  GpuCuller(VkAllocator &allocator, PipelineCache &pipeline_cache,
+            vk::ShaderModule cull_shader, uint32_t frame_count,
+            bool draw_indirect_count, bool multi_draw_indirect,
+            bool verify = false,
+            uint32_t frame_capacity = default_frame_capacity);
+
+  GpuCuller(const GpuCuller &other) = delete;
+  GpuCuller(GpuCuller &&other) = delete;
+  GpuCuller &operator=(const GpuCuller &other) = delete;
+  GpuCuller &operator=(GpuCuller &&other) = delete;
+
+  ~GpuCuller() = default;
+
+  // An object is kept if any view sees it: it intersects the view's frustum
+  // and, for meshlets, some of it faces the view's position.
+  void begin_frame(uint32_t frame, const glm::mat4 *view_projections,
+                   const glm::vec3 *view_positions, uint32_t view_count);
+
+  // Adds one object per meshlet if the mesh has them. The mesh must have
+  // 32-bit indices.
+  void add(const Mesh &mesh, const glm::mat4 &model);
+
+  // Records the cull pass outside of a render pass; draws recorded after it
+  // on the same queue see its results.
+  void dispatch(vk::CommandBuffer commands);
+
+  // Expects the geometry pool and an instanced pipeline to be bound.
+  void draw(vk::CommandBuffer command_buffer) const;
+
+  // Compares the last dispatch against the same test on the CPU. The caller
+  // must have waited for the dispatch to complete; needs `verify` set at
+  // construction so the results are host visible.
+  auto verify() -> bool;
+
+  // Objects the last dispatch kept, in the order they were added. Has the
+  // same requirements as verify().
+  [[nodiscard]] auto kept_objects() const -> std::vector<uint32_t>;
+
+  [[nodiscard]] auto instance_buffer() const { return model_buffer_; }
+  // Objects added this frame; draw() issues up to this many draws.
+  [[nodiscard]] auto object_count() const {
+    return static_cast<uint32_t>(objects_.size());
+  }
+  [[nodiscard]] auto compacting() const { return draw_indirect_count_; }
+  [[nodiscard]] auto stats() const { return stats_; }
+
+  void destroy();
+
+private:
+  struct Object {
+    glm::mat4 model;
+    glm::vec4 sphere;
+    // World space axis and cutoff of the normal cone; a cutoff of 1 never
+    // culls.
+    glm::vec4 cone;
+    // The diagonal and offset of the mesh's decode matrix.
+    glm::vec4 decode_scale;
+    glm::vec4 decode_offset;
+    uint32_t index_count;
+    uint32_t first_index;
+    int32_t vertex_offset;
+    uint32_t padding;
+  };
+
+  struct Frame {
+    glm::vec4 planes[max_views * 6];
+    glm::vec4 positions[max_views];
+    uint32_t object_count;
+    uint32_t view_count;
+    uint32_t first_instance;
+    uint32_t slot;
+  };
+
+  // vk::DrawIndexedIndirectCommand followed by the source object, which is
+  // only read back when verifying.
+  struct Command {
+    vk::DrawIndexedIndirectCommand draw;
+    uint32_t object;
+  };
+
+  void create_pipeline(PipelineCache &pipeline_cache,
+                       vk::ShaderModule cull_shader);
+  void create_descriptor_sets();
+
+  vk::Device device_;
+  VkAllocator *allocator_;
+
+  bool draw_indirect_count_;
+  bool multi_draw_indirect_;
+  bool verify_;
+
+  uint32_t frame_capacity_;
+  uint32_t frame_count_;
+  uint32_t slot_{0};
+  vk::DeviceSize frame_stride_;
+
+  vk::Buffer frame_buffer_;
+  VkAllocation frame_allocation_;
+  vk::Buffer object_buffer_;
+  VkAllocation object_allocation_;
+  vk::Buffer indirect_buffer_;
+  VkAllocation indirect_allocation_;
+  vk::Buffer count_buffer_;
+  VkAllocation count_allocation_;
+  vk::Buffer model_buffer_;
+  VkAllocation model_allocation_;
+
+  vk::DescriptorSetLayout set_layout_;
+  vk::DescriptorPool descriptor_pool_;
+  std::vector<vk::DescriptorSet> descriptor_sets_;
+  vk::PipelineLayout pipeline_layout_;
+  vk::Pipeline pipeline_;
+
+  Frame frame_{};
+  std::vector<Object> objects_;
+
+  CullStats stats_;
+};
+
+} // namespace mov
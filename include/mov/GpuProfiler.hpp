@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mov {
+
+// Over the last `window` frames a scope was recorded in.
+struct GpuTimingStats {
+  uint64_t samples{0};
+  double min_ms{0.};
+  double average_ms{0.};
+  double p99_ms{0.};
+  double last_ms{0.};
+};
+
+// Times named regions of command buffers with timestamp queries and wraps
+// them in VK_EXT_debug_utils labels of the same name, so captures taken with
+// external tools show the same structure. Each frame slot has its own range
+// of queries, which is read back when the slot comes round again, so
+// reading never waits on the GPU. A scope recorded several times in a frame,
+// e.g. once per recording thread, counts as one sample of their sum.
+class GpuProfiler {
+public:
+  static constexpr uint32_t default_query_capacity = 256;
+  static constexpr uint32_t default_window = 512;
+
+  struct Scope {
+    uint32_t name{0};
+    // First of the begin timestamp's queries, followed by the end's; ~0u
+    // when the slot ran out of queries.
+    uint32_t query{~0u};
+    uint32_t view_count{1};
+  };
+
+  // A timestamp_period of 0 records labels only. Labels need the instance
+  // to have VK_EXT_debug_utils enabled; without it they are left out.
+  GpuProfiler(vk::Instance instance, vk::Device device, uint32_t frame_count,
+              float timestamp_period,
+              uint32_t query_capacity = default_query_capacity,
+              uint32_t window = default_window);
+
+  GpuProfiler(const GpuProfiler &other) = delete;
+  GpuProfiler(GpuProfiler &&other) = delete;
+  GpuProfiler &operator=(const GpuProfiler &other) = delete;
+  GpuProfiler &operator=(GpuProfiler &&other) = delete;
+
+  ~GpuProfiler() = default;
+
+  // Collects the slot's results from frame_count frames ago, which needs the
+  // slot's previous submit to have finished, and resets its queries in
+  // `commands`. Those must execute before anything this frame records.
+  void begin_frame(uint32_t slot, vk::CommandBuffer commands);
+
+  // Starts a scope. Inside a multiview render pass every timestamp takes
+  // one query per view, so pass the pass's view count. Safe to call from
+  // several recording threads.
+  auto begin(vk::CommandBuffer commands, std::string_view name,
+             uint32_t view_count = 1) -> Scope;
+  void end(vk::CommandBuffer commands, const Scope &scope);
+
+  [[nodiscard]] auto stats(std::string_view name) const -> GpuTimingStats;
+  // Every scope recorded so far, in the order they were first seen.
+  [[nodiscard]] auto report() const
+      -> std::vector<std::pair<std::string, GpuTimingStats>>;
+
+  [[nodiscard]] auto timing() const { return timestamp_period_ > 0.f; }
+
+  void destroy();
+
+private:
+  struct Pending {
+    uint32_t name;
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  void collect(uint32_t slot);
+
+  vk::Device device_;
+  float timestamp_period_;
+  uint32_t query_capacity_;
+  uint32_t window_;
+  vk::QueryPool query_pool_;
+
+  PFN_vkCmdBeginDebugUtilsLabelEXT begin_label_{nullptr};
+  PFN_vkCmdEndDebugUtilsLabelEXT end_label_{nullptr};
+
+  // Guards everything below; scopes are opened from recording threads.
+  mutable std::mutex mutex_;
+
+  uint32_t slot_{0};
+  std::vector<uint32_t> used_;
+  std::vector<std::vector<Pending>> pending_;
+
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::vector<std::deque<double>> samples_;
+};
+
+} // namespace mov
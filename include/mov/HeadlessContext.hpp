@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+namespace mov {
+
+struct HeadlessFeatures {
+  bool draw_indirect_count{false};
+  bool multi_draw_indirect{false};
+};
+
+// A Vulkan instance and device without a window, surface or OpenXR runtime,
+// for tests and benchmarks. Any device with a graphics and compute queue
+// will do, software drivers such as lavapipe included; set MOV_DEVICE to
+// part of a device name to pick one when there are several.
+class HeadlessContext {
+public:
+  HeadlessContext();
+
+  HeadlessContext(const HeadlessContext &other) = delete;
+  HeadlessContext(HeadlessContext &&other) = delete;
+  HeadlessContext &operator=(const HeadlessContext &other) = delete;
+  HeadlessContext &operator=(HeadlessContext &&other) = delete;
+
+  ~HeadlessContext() = default;
+
+  [[nodiscard]] auto instance() const { return instance_; }
+  [[nodiscard]] auto physical_device() const { return physical_device_; }
+  [[nodiscard]] auto device() const { return device_; }
+
+  // Graphics, compute and transfer all go through this one queue.
+  [[nodiscard]] auto queue() const { return queue_; }
+  [[nodiscard]] auto queue_family() const { return queue_family_; }
+
+  [[nodiscard]] auto features() const { return features_; }
+
+  // Nanoseconds per timestamp tick on the queue; 0 if it has no timestamps.
+  [[nodiscard]] auto timestamp_period() const { return timestamp_period_; }
+
+  // Submits the commands recorded by `record` and waits for them.
+  template <typename Record> void submit(Record &&record) const {
+    const auto commands = begin_commands();
+    record(commands);
+    end_commands(commands);
+  }
+
+  void destroy();
+
+private:
+  [[nodiscard]] auto begin_commands() const -> vk::CommandBuffer;
+  void end_commands(vk::CommandBuffer commands) const;
+
+  vk::Instance instance_;
+  vk::PhysicalDevice physical_device_;
+  vk::Device device_;
+  vk::Queue queue_;
+  uint32_t queue_family_{0};
+  vk::CommandPool command_pool_;
+
+  HeadlessFeatures features_;
+  float timestamp_period_{0.f};
+};
+
+} // namespace mov
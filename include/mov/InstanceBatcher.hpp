@@ -0,0 +1,76 @@
+#pragma once
+
+#include <mov/GeometryPool.hpp>
+#include <mov/Mesh.hpp>
+#include <mov/VkAllocator.hpp>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace mov {
+
+struct InstanceStats {
+  uint64_t instances{0};
+  uint64_t draws{0};
+};
+
+// Groups objects that share a mesh and draws each group with a single
+// instanced drawIndexed. Model matrices go into a per-frame slice of a
+// persistently mapped storage buffer and are indexed by gl_InstanceIndex.
+class InstanceBatcher {
+public:
+  static constexpr uint32_t default_frame_capacity = 16 * 1024;
+
+  InstanceBatcher(VkAllocator &allocator, uint32_t frame_count,
+                  uint32_t frame_capacity = default_frame_capacity);
+
+  InstanceBatcher(const InstanceBatcher &other) = delete;
+  InstanceBatcher(InstanceBatcher &&other) = delete;
+  InstanceBatcher &operator=(const InstanceBatcher &other) = delete;
+  InstanceBatcher &operator=(InstanceBatcher &&other) = delete;
+
+  ~InstanceBatcher() = default;
+
+  void begin_frame(uint32_t frame);
+
+  void add(const Mesh &mesh, const glm::mat4 &model);
+
+  // Expects the geometry pool and an instanced pipeline to be bound. The
+  // matrices are written on the first call of a frame, so recording the
+  // same frame for several views reuses them.
+  void draw(vk::CommandBuffer command_buffer);
+
+  [[nodiscard]] auto buffer() const { return buffer_; }
+  [[nodiscard]] auto stats() const { return stats_; }
+
+  void destroy();
+
+private:
+  struct Group {
+    Mesh mesh;
+    std::vector<glm::mat4> models;
+    uint32_t first_instance{0};
+  };
+
+  void write();
+
+  VkAllocator *allocator_;
+
+  vk::Buffer buffer_;
+  VkAllocation allocation_;
+
+  uint32_t frame_capacity_;
+  uint32_t frame_count_;
+  uint32_t frame_begin_{0};
+  bool written_{false};
+
+  std::unordered_map<GeometryPool::Handle, uint32_t> group_indices_;
+  std::vector<Group> groups_;
+
+  InstanceStats stats_;
+};
+
+} // namespace mov
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <mov/Mesh.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace mov {
+
+struct MeshLod {
+  Mesh mesh;
+  // Object space distance the level's surface may be off the full
+  // resolution one by.
+  float error{0.f};
+};
+
+// Where the levels are selected for.
+struct LodView {
+  glm::vec3 position{0.f};
+  // Pixels covered by one unit at a distance of one unit: the image height
+  // over the vertical extent of the field of view in tangent space.
+  float projection_scale{1.f};
+  // Largest error, in pixels, a level may show on screen.
+  float max_pixel_error{1.f};
+  // How far below max_pixel_error a coarser level has to be before it
+  // replaces the current one, so objects near a switching distance do not
+  // flicker between levels.
+  float hysteresis{0.25f};
+};
+
+// A mesh and its simplified versions, finest first, with the level in use.
+class LodChain {
+public:
+  LodChain() = default;
+
+  LodChain(const Mesh &mesh) : levels_{{mesh, 0.f}} {}
+
+  explicit LodChain(std::vector<MeshLod> levels);
+
+  // Switches to the coarsest level that stays under the view's pixel error
+  // at `distance`; `scale` is how much the model matrix enlarges the mesh.
+  void select(const LodView &view, float distance, float scale = 1.f);
+
+  [[nodiscard]] auto current() const -> const Mesh & {
+    return levels_[current_].mesh;
+  }
+  [[nodiscard]] auto level() const { return current_; }
+  [[nodiscard]] auto levels() const -> const std::vector<MeshLod> & {
+    return levels_;
+  }
+
+  void destroy() const;
+
+private:
+  std::vector<MeshLod> levels_;
+  uint32_t current_{0};
+};
+
+} // namespace mov
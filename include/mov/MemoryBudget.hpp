@@ -0,0 +1,62 @@
+#pragma once
+
+#include <mov/VkAllocator.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace mov {
+
+struct MemoryHeapReport {
+  vk::DeviceSize usage{0};
+  vk::DeviceSize budget{0};
+  vk::DeviceSize high_water{0};
+
+  bool device_local{false};
+
+  [[nodiscard]] auto share() const {
+    return budget == 0 ? 0.f
+                       : static_cast<float>(usage) / static_cast<float>(budget);
+  }
+};
+
+struct MemoryReport {
+  std::vector<MemoryHeapReport> heaps;
+
+  MemoryCategoryUsage categories{};
+  MemoryCategoryUsage category_high_water{};
+
+  // False when VK_EXT_memory_budget is unavailable and usage/budget come from
+  // the allocator's own block counters and the heap sizes.
+  bool from_driver{false};
+};
+
+class MemoryBudget {
+public:
+  using Callback = std::function<void(uint32_t heap, const MemoryHeapReport &)>;
+
+  MemoryBudget(const VkAllocator &allocator, bool memory_budget_enabled);
+
+  // Fires once each time a heap's usage rises above share * budget.
+  void on_threshold(float share, Callback callback);
+
+  auto update() -> const MemoryReport &;
+
+  [[nodiscard]] auto report() const -> const MemoryReport & {
+    return report_;
+  }
+
+private:
+  const VkAllocator *allocator_;
+  bool memory_budget_enabled_;
+
+  float threshold_{1.f};
+  Callback callback_;
+  std::vector<bool> above_threshold_;
+
+  MemoryReport report_;
+};
+
+} // namespace mov
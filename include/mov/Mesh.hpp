@@ -1,10 +1,15 @@
 #pragma once
 
+#include <mov/Bounds.hpp>
+#include <mov/GeometryPool.hpp>
+#include <mov/Meshlets.hpp>
+#include <mov/PackedVertex.hpp>
 #include <mov/Vertex.hpp>
-#include <mov/VkBuffer.hpp>
 
 #include <vulkan/vulkan.hpp>
 
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace mov {
@@ -13,50 +18,77 @@ class Mesh {
 public:
   Mesh() = default;
 
-  Mesh(const mov::VkBufferProvider provider,
-        const std::vector<Vertex> &vertices,
-        const std::vector<uint32_t> &indices)
-      : vertices_(provider, vk::BufferUsageFlagBits::eVertexBuffer,
-                  vertices.data(), vertices.size()),
-        indices_(provider, vk::BufferUsageFlagBits::eIndexBuffer,
-                 indices.data(), indices.size()),
-        index_count_(static_cast<uint32_t>(indices.size())) {}
-
-  Mesh(const mov::Mesh &other) {
-    this->vertices_ = other.vertices_;
-    this->indices_ = other.indices_;
-    this->index_count_ = other.index_count_;
-  }
+  Mesh(GeometryPool &pool, const std::vector<Vertex> &vertices,
+       const std::vector<uint32_t> &indices)
+      : pool_(&pool), handle_(pool.allocate(vertices, indices)),
+        box_(compute_bounding_box(vertices)),
+        sphere_(compute_bounding_sphere(vertices)) {}
+
+  // Stores the vertices in `format`; bounds come from the full precision
+  // positions either way. Meshlets, if any, must cover `indices`. With
+  // compact_indices the indices are stored as 16 bits when every vertex
+  // index fits; such meshes can be drawn directly or instanced, but not
+  // culled on the GPU.
+  Mesh(GeometryPool &pool, const std::vector<VertexAttributes> &vertices,
+       const std::vector<uint32_t> &indices, VertexFormat format,
+       std::vector<Meshlet> meshlets = {}, bool compact_indices = false);
+
+  Mesh(const Mesh &other) = default;
+  Mesh &operator=(const Mesh &other) = default;
 
-  Mesh &operator=(Mesh &&other) noexcept {
-    this->vertices_ = other.vertices_;
-    this->indices_ = other.indices_;
-    this->index_count_ = other.index_count_;
+  // Expects the pool's buffers to be bound on command_buffer already. A
+  // 16-bit mesh rebinds the index buffer around its draw, so the pool is
+  // left bound as eUint32 for the next one.
+  auto draw(const vk::CommandBuffer command_buffer,
+            const uint32_t instance_count = 1,
+            const uint32_t first_instance = 0) const {
+    const auto [index_count, first_index, vertex_offset, type] =
+        pool_->draw(handle_);
+    const auto compact = type != vk::IndexType::eUint32;
 
-    return *this;
-  }
-
-  Mesh &operator=(const Mesh &other) = default;
+    if (compact)
+      pool_->bind_indices(command_buffer, type);
 
-  auto draw(const vk::CommandBuffer command_buffer) const {
-    constexpr vk::DeviceSize offsets[] = {0};
+    command_buffer.drawIndexed(index_count, instance_count, first_index,
+                               vertex_offset, first_instance);
 
-    command_buffer.bindVertexBuffers(0, 1, &vertices_.buffer, offsets);
-    command_buffer.bindIndexBuffer(indices_.buffer, 0, vk::IndexType::eUint32);
+    if (compact)
+      pool_->bind_indices(command_buffer, vk::IndexType::eUint32);
+  }
 
-    command_buffer.drawIndexed(index_count_, 1, 0, 0, 0);
+  [[nodiscard]] auto handle() const { return handle_; }
+  [[nodiscard]] auto draw_parameters() const { return pool_->draw(handle_); }
+  [[nodiscard]] auto index_type() const {
+    return pool_->draw(handle_).index_type;
+  }
+  // Object space bounds, computed from the vertices when the mesh is created.
+  [[nodiscard]] auto bounding_box() const { return box_; }
+  [[nodiscard]] auto bounding_sphere() const { return sphere_; }
+
+  // Empty unless the mesh was split into meshlets; copies of the mesh
+  // share them.
+  [[nodiscard]] auto meshlets() const -> std::span<const Meshlet> {
+    return meshlets_ ? std::span<const Meshlet>(*meshlets_)
+                     : std::span<const Meshlet>();
   }
 
-  auto destroy() const {
-    vertices_.destroy();
-    indices_.destroy();
+  [[nodiscard]] auto format() const { return format_; }
+  // Applied to the vertex positions before the model matrix; identity for
+  // float vertices.
+  [[nodiscard]] auto decode_matrix() const -> const glm::mat4 & {
+    return decode_;
   }
 
-private:
-  VkBuffer<Vertex> vertices_;
-  VkBuffer<uint32_t> indices_;
+  auto destroy() const { pool_->free(handle_); }
 
-  uint32_t index_count_{0};
+private:
+  GeometryPool *pool_{nullptr};
+  GeometryPool::Handle handle_{GeometryPool::invalid_handle};
+  BoundingBox box_;
+  BoundingSphere sphere_;
+  VertexFormat format_{VertexFormat::Float};
+  glm::mat4 decode_{1.f};
+  std::shared_ptr<const std::vector<Meshlet>> meshlets_;
 };
 
 }; // namespace mov
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <mov/PackedVertex.hpp>
+
+#include <span>
+#include <vector>
+
+namespace mov {
+
+struct SimplifiedMesh {
+  std::vector<uint32_t> indices;
+  // Largest distance, in object space units, the surface moved by; 0 when
+  // nothing was collapsed.
+  float error{0.f};
+};
+
+// Collapses edges in order of quadric error (Garland and Heckbert,
+// "Surface Simplification Using Quadric Error Metrics") until the index
+// count reaches target_index_count or the next collapse would exceed
+// max_error. Vertices only ever move onto a neighbour, so the result indexes
+// the same vertices and keeps their attributes. Mesh borders and attribute
+// seams are left in place so the mesh does not open up.
+[[nodiscard]] auto
+simplify_mesh(std::span<const uint32_t> indices,
+              const std::vector<VertexAttributes> &vertices,
+              uint32_t target_index_count, float max_error) -> SimplifiedMesh;
+
+struct LodSettings {
+  // Triangles kept by each level relative to the one before it.
+  float target_ratio{0.5f};
+  // Largest error a level may have, relative to the mesh's bounding radius.
+  float max_error{0.05f};
+  // Including the full resolution mesh.
+  uint32_t max_levels{4};
+};
+
+// Level 0 is the mesh itself. Each further level is simplified from the
+// full resolution mesh, and the chain stops early once a level can no
+// longer get meaningfully smaller within the error bound.
+[[nodiscard]] auto generate_lods(std::span<const uint32_t> indices,
+                                 const std::vector<VertexAttributes> &vertices,
+                                 const LodSettings &settings = {})
+    -> std::vector<SimplifiedMesh>;
+
+} // namespace mov
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <mov/Bounds.hpp>
+#include <mov/PackedVertex.hpp>
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <vector>
+
+namespace mov {
+
+// A run of consecutive triangles in a mesh's index buffer, small enough to
+// be culled on its own.
+struct Meshlet {
+  // Relative to the mesh's first index.
+  uint32_t first_index{0};
+  uint32_t index_count{0};
+
+  // Object space, like the mesh's bounds.
+  BoundingSphere sphere;
+
+  // Every triangle faces away from a viewer at v when
+  //   dot(sphere.center - v, cone_axis) >=
+  //       cone_cutoff * length(sphere.center - v) + sphere.radius
+  // A cutoff of 1 never passes, for clusters facing too many ways at once.
+  glm::vec3 cone_axis{0.f, 0.f, 1.f};
+  float cone_cutoff{1.f};
+};
+
+// The limits mesh shading hardware is commonly tuned for, so the same
+// clusters can later feed a mesh shader path.
+constexpr uint32_t max_meshlet_vertices = 64;
+constexpr uint32_t max_meshlet_triangles = 124;
+
+// Splits the triangles, in their current order, into meshlets of at most
+// max_meshlet_vertices unique vertices and max_meshlet_triangles triangles.
+// Cache optimised meshes cluster well, since neighbouring triangles are
+// already close together. Without `cones` no meshlet is back face culled,
+// for meshes that are open or drawn double sided.
+[[nodiscard]] auto build_meshlets(std::span<const uint32_t> indices,
+                                  const std::vector<VertexAttributes> &vertices,
+                                  bool cones = true) -> std::vector<Meshlet>;
+
+} // namespace mov
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <vector>
+
+namespace mov {
+
+enum class VertexFormat : uint32_t {
+  // mov::Vertex: float position and color.
+  Float,
+  // mov::PackedVertex, decoded with the mesh's decode matrix.
+  Packed,
+};
+
+// Everything an importer knows about a vertex, at full precision. Meshes are
+// built from these and stored in whichever VertexFormat they are asked for.
+struct VertexAttributes {
+  glm::vec3 position{0.f};
+  glm::vec3 color{1.f};
+  glm::vec3 normal{0.f, 0.f, 1.f};
+  // w is the handedness of the bitangent, +1 or -1.
+  glm::vec4 tangent{1.f, 0.f, 0.f, 1.f};
+  glm::vec2 uv{0.f};
+};
+
+// 20 bytes instead of the 56 the same attributes take as floats:
+// - position as 16-bit UNORM relative to the mesh bounds, with the tangent
+//   handedness in w (0 or 1)
+// - color as UNORM8
+// - normal and tangent octahedral encoded as SNORM8 pairs
+// - uv as half floats
+// The vertex shader sees positions in [0, 1] and must apply the mesh's
+// decode matrix, which only scales and offsets; normals are stored in
+// object space and must not go through it.
+struct PackedVertex {
+  std::array<uint16_t, 4> position;
+  std::array<uint8_t, 4> color;
+  std::array<int8_t, 4> normal_tangent;
+  uint32_t uv;
+
+  static auto get_binding_description() -> vk::VertexInputBindingDescription {
+    return vk::VertexInputBindingDescription()
+        .setBinding(0)
+        .setStride(sizeof(PackedVertex))
+        .setInputRate(vk::VertexInputRate::eVertex);
+  }
+
+  // Locations 0 and 1 match mov::Vertex, so the same shaders read both.
+  static auto get_attribute_descriptions()
+      -> std::array<vk::VertexInputAttributeDescription, 4> {
+    return {vk::VertexInputAttributeDescription()
+                .setBinding(0)
+                .setLocation(0)
+                .setFormat(vk::Format::eR16G16B16A16Unorm)
+                .setOffset(offsetof(PackedVertex, position)),
+            vk::VertexInputAttributeDescription()
+                .setBinding(0)
+                .setLocation(1)
+                .setFormat(vk::Format::eR8G8B8A8Unorm)
+                .setOffset(offsetof(PackedVertex, color)),
+            vk::VertexInputAttributeDescription()
+                .setBinding(0)
+                .setLocation(2)
+                .setFormat(vk::Format::eR8G8B8A8Snorm)
+                .setOffset(offsetof(PackedVertex, normal_tangent)),
+            vk::VertexInputAttributeDescription()
+                .setBinding(0)
+                .setLocation(3)
+                .setFormat(vk::Format::eR16G16Sfloat)
+                .setOffset(offsetof(PackedVertex, uv))};
+  }
+};
+
+static_assert(sizeof(PackedVertex) == 20);
+
+struct PackedVertices {
+  std::vector<PackedVertex> vertices;
+  // Maps the UNORM positions back to object space.
+  glm::mat4 decode{1.f};
+};
+
+[[nodiscard]] auto pack_vertices(const std::vector<VertexAttributes> &vertices)
+    -> PackedVertices;
+
+// Unit vector to a point in [-1, 1]^2; see "A Survey of Efficient
+// Representations for Independent Unit Vectors" (Cigolle et al. 2014).
+// Zero, infinite and NaN vectors encode as (0, 0, 1).
+[[nodiscard]] auto octahedral_encode(glm::vec3 normal) -> glm::vec2;
+[[nodiscard]] auto octahedral_decode(glm::vec2 encoded) -> glm::vec3;
+
+} // namespace mov
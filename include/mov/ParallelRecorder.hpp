@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mov {
+
+struct RecordStats {
+  uint64_t items{0};
+  uint64_t slices{0};
+  uint64_t recordings{0};
+
+  std::chrono::nanoseconds busy{0};
+
+  [[nodiscard]] auto microseconds_per_recording() const {
+    return recordings > 0
+               ? std::chrono::duration<double, std::micro>(busy).count() /
+                     static_cast<double>(recordings)
+               : 0.;
+  }
+};
+
+// Records draws on a pool of worker threads. Each worker owns a command pool
+// per frame in flight and records one contiguous slice of the items into a
+// secondary command buffer; the primary executes the slices in order, so the
+// draw order does not depend on which worker finishes first. The calling
+// thread records the first slice itself.
+class ParallelRecorder {
+public:
+  // Records items [begin, end) into a secondary command buffer. Nothing is
+  // inherited from the primary but the render pass, so it has to bind its
+  // own pipeline, descriptors and dynamic state.
+  using Record =
+      std::function<void(vk::CommandBuffer, uint32_t begin, uint32_t end)>;
+
+  static constexpr uint32_t default_min_slice_size = 64;
+
+  ParallelRecorder(vk::Device device, uint32_t queue_family_index,
+                   uint32_t frame_count,
+                   uint32_t worker_count = std::thread::hardware_concurrency(),
+                   uint32_t min_slice_size = default_min_slice_size);
+
+  ParallelRecorder(const ParallelRecorder &other) = delete;
+  ParallelRecorder(ParallelRecorder &&other) = delete;
+  ParallelRecorder &operator=(const ParallelRecorder &other) = delete;
+  ParallelRecorder &operator=(ParallelRecorder &&other) = delete;
+
+  ~ParallelRecorder() = default;
+
+  // Resets the command pools of this frame's slot, which the GPU must be
+  // done with.
+  void begin_frame(uint32_t frame);
+
+  // Must be called inside a render pass begun with
+  // vk::SubpassContents::eSecondaryCommandBuffers.
+  void record(vk::CommandBuffer primary,
+              const vk::CommandBufferInheritanceInfo &inheritance,
+              uint32_t item_count, const Record &record);
+
+  [[nodiscard]] auto worker_count() const {
+    return static_cast<uint32_t>(workers_.size());
+  }
+  [[nodiscard]] auto stats() const { return stats_; }
+
+  void destroy();
+
+private:
+  struct Worker {
+    std::vector<vk::CommandPool> pools;
+    std::vector<std::vector<vk::CommandBuffer>> buffers;
+    uint32_t used{0};
+  };
+
+  void run(uint32_t worker);
+  void record_slice(uint32_t worker);
+
+  vk::Device device_;
+
+  uint32_t frame_count_;
+  uint32_t min_slice_size_;
+  uint32_t slot_{0};
+
+  std::vector<Worker> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  uint64_t generation_{0};
+  uint32_t pending_{0};
+  bool stopping_{false};
+
+  // The job being recorded; only written while no worker is running.
+  const Record *record_{nullptr};
+  const vk::CommandBufferInheritanceInfo *inheritance_{nullptr};
+  uint32_t item_count_{0};
+  uint32_t slice_count_{0};
+  std::vector<vk::CommandBuffer> slices_;
+
+  RecordStats stats_;
+};
+
+} // namespace mov
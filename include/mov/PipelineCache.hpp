@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+namespace mov {
+
+enum class PipelineCacheLoad : uint32_t {
+  Missing,
+  Loaded,
+  // The file exists but was written by another device or driver, or is
+  // damaged; the cache starts out empty.
+  Rejected,
+};
+
+constexpr auto to_string(const PipelineCacheLoad load) {
+  constexpr const char *names[] = {"missing", "loaded", "rejected"};
+  return names[static_cast<uint32_t>(load)];
+}
+
+struct PipelineCacheStats {
+  uint32_t pipelines{0};
+
+  // Only known when the driver reports creation feedback.
+  uint32_t hits{0};
+  bool feedback{false};
+
+  std::chrono::nanoseconds creation{0};
+
+  // Estimated from the average time a miss has taken, across every run that
+  // has written the file so far.
+  std::chrono::nanoseconds saved{0};
+
+  [[nodiscard]] auto creation_ms() const {
+    return std::chrono::duration<double, std::milli>(creation).count();
+  }
+
+  [[nodiscard]] auto saved_ms() const {
+    return std::chrono::duration<double, std::milli>(saved).count();
+  }
+};
+
+// A VkPipelineCache backed by a file. The blob is only handed to the driver
+// if its header matches this vendor, device and pipeline cache UUID, and it
+// is written back through a temporary file so a crash mid-save never leaves
+// a truncated cache behind.
+class PipelineCache {
+public:
+  PipelineCache(vk::Device device, vk::PhysicalDevice physical_device,
+                std::filesystem::path path, bool creation_feedback);
+
+  PipelineCache(const PipelineCache &other) = delete;
+  PipelineCache(PipelineCache &&other) = delete;
+  PipelineCache &operator=(const PipelineCache &other) = delete;
+  PipelineCache &operator=(PipelineCache &&other) = delete;
+
+  ~PipelineCache() = default;
+
+  [[nodiscard]] auto
+  create_graphics_pipeline(const vk::GraphicsPipelineCreateInfo &create_info)
+      -> vk::ResultValue<vk::Pipeline>;
+
+  [[nodiscard]] auto
+  create_compute_pipeline(const vk::ComputePipelineCreateInfo &create_info)
+      -> vk::ResultValue<vk::Pipeline>;
+
+  // Writes the cache if a pipeline was compiled since the last save. Returns
+  // false if writing failed; the previous file is then left untouched.
+  auto save() -> bool;
+
+  [[nodiscard]] auto handle() const { return cache_; }
+  [[nodiscard]] auto load_result() const { return load_; }
+  [[nodiscard]] auto path() const -> const auto & { return path_; }
+  [[nodiscard]] auto stats() const -> PipelineCacheStats;
+
+  void destroy();
+
+private:
+  // Precedes the driver's blob in the file.
+  struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t driver_version;
+    uint32_t reserved;
+    uint64_t data_size;
+
+    // Compile history, so later runs can tell what a hit saved.
+    uint64_t miss_count;
+    uint64_t miss_nanoseconds;
+  };
+
+  static constexpr uint32_t file_magic = 0x50564f4d; // "MOVP"
+  static constexpr uint32_t file_version = 1;
+
+  auto load() -> std::vector<std::byte>;
+  [[nodiscard]] auto matches_device(const std::vector<std::byte> &data) const
+      -> bool;
+
+  void record(std::chrono::nanoseconds duration,
+              const vk::PipelineCreationFeedbackEXT &feedback);
+
+  vk::Device device_;
+  vk::PhysicalDeviceProperties properties_;
+  std::filesystem::path path_;
+  bool creation_feedback_;
+
+  vk::PipelineCache cache_;
+  PipelineCacheLoad load_{PipelineCacheLoad::Missing};
+
+  uint64_t history_misses_{0};
+  std::chrono::nanoseconds history_miss_time_{0};
+
+  uint32_t pipelines_{0};
+  uint32_t hits_{0};
+  bool stale_{true};
+  std::chrono::nanoseconds creation_{0};
+  std::chrono::nanoseconds hit_time_{0};
+  uint64_t misses_{0};
+  std::chrono::nanoseconds miss_time_{0};
+};
+
+} // namespace mov
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <mov/PackedVertex.hpp>
+#include <mov/PipelineCache.hpp>
+#include <mov/ShaderRegistry.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <unordered_map>
+
+namespace mov {
+
+struct PipelineVariantStats {
+  uint32_t variants{0};
+  uint64_t lookups{0};
+};
+
+// Everything a mesh pipeline is built from. The flags become specialization
+// constants, so each variant is compiled with the branches it does not take
+// removed; view_count picks the multiview or the single-view vertex shader.
+struct PipelineKey {
+  vk::RenderPass render_pass;
+  vk::PipelineLayout layout;
+  uint32_t view_count{1};
+  VertexFormat vertex_format{VertexFormat::Float};
+
+  // Specialization constants of vertex.vert.
+  bool instanced{false};
+  bool vertex_color{true};
+
+  vk::PrimitiveTopology topology{vk::PrimitiveTopology::eTriangleList};
+  vk::PolygonMode polygon_mode{vk::PolygonMode::eFill};
+  vk::CullModeFlags cull_mode{vk::CullModeFlagBits::eNone};
+  bool depth_write{true};
+  bool blend{true};
+
+  bool operator==(const PipelineKey &other) const = default;
+};
+
+struct PipelineKeyHash {
+  auto operator()(const PipelineKey &key) const -> size_t;
+};
+
+// Creates mesh pipelines on first use and hands out the same vk::Pipeline
+// for every later request with an equal key. Creation goes through the
+// pipeline cache, so a variant compiled in an earlier run is not compiled
+// again.
+class PipelineVariants {
+public:
+  PipelineVariants(vk::Device device, PipelineCache &pipeline_cache,
+                   ShaderRegistry &shaders);
+
+  PipelineVariants(const PipelineVariants &other) = delete;
+  PipelineVariants(PipelineVariants &&other) = delete;
+  PipelineVariants &operator=(const PipelineVariants &other) = delete;
+  PipelineVariants &operator=(PipelineVariants &&other) = delete;
+
+  ~PipelineVariants() = default;
+
+  auto get(const PipelineKey &key) -> vk::Pipeline;
+
+  [[nodiscard]] auto stats() const -> PipelineVariantStats;
+
+  void destroy();
+
+private:
+  auto create(const PipelineKey &key) -> vk::Pipeline;
+  auto shader(const std::string &name) -> vk::ShaderModule;
+
+  vk::Device device_;
+  PipelineCache *pipeline_cache_;
+  ShaderRegistry *shaders_;
+
+  std::unordered_map<PipelineKey, vk::Pipeline, PipelineKeyHash> pipelines_;
+  std::unordered_map<std::string, vk::ShaderModule> modules_;
+
+  uint64_t lookups_{0};
+};
+
+} // namespace mov
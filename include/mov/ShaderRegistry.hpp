@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace mov {
+
+// A compiled shader built into the binary; see data/CMakeLists.txt.
+struct EmbeddedShader {
+  std::string_view name;
+  std::span<const uint32_t> code;
+};
+
+// Creates shader modules by source name, e.g. "vertex.vert", straight from
+// the SPIR-V embedded at build time. When an override directory is given,
+// a <name>.spv found there is used instead, so shaders can be rebuilt and
+// tried without relinking.
+class ShaderRegistry {
+public:
+  explicit ShaderRegistry(std::span<const EmbeddedShader> shaders,
+                          std::filesystem::path override_directory = {});
+
+  // Empty if no shader of that name was embedded.
+  [[nodiscard]] auto find(std::string_view name) const
+      -> std::span<const uint32_t>;
+
+  [[nodiscard]] auto create_module(vk::Device device, std::string_view name)
+      -> vk::ShaderModule;
+
+  // Modules created from the override directory rather than the binary.
+  [[nodiscard]] auto overridden() const { return overridden_; }
+
+private:
+  std::span<const EmbeddedShader> shaders_;
+  std::filesystem::path override_directory_;
+
+  uint32_t overridden_{0};
+};
+
+} // namespace mov
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mov {
+
+#ifdef MOV_TRACING
+inline constexpr bool tracing_enabled = true;
+#else
+inline constexpr bool tracing_enabled = false;
+#endif
+
+struct TraceEvent {
+  const char *name;
+  // Nanoseconds since the tracer was created.
+  int64_t begin;
+  int64_t end;
+};
+
+struct TraceStats {
+  uint64_t events{0};
+  // Events overwritten by newer ones before they could be written out.
+  uint64_t overwritten{0};
+  uint32_t threads{0};
+};
+
+// Records named CPU zones into a ring buffer per thread and writes them out
+// in the Chrome trace event format, which chrome://tracing and Perfetto
+// open. Recording takes no lock: a thread only writes its own buffer and
+// publishes each event with one atomic store, so traces can be written while
+// other threads keep recording. Each thread keeps its newest
+// buffer_capacity events.
+//
+// Zones are opened with MOV_TRACE_ZONE, which compiles to nothing unless
+// MOV_TRACING is defined.
+class Tracer {
+public:
+  static constexpr uint64_t buffer_capacity = 1 << 16;
+
+  static auto get() -> Tracer &;
+
+  Tracer(const Tracer &other) = delete;
+  Tracer(Tracer &&other) = delete;
+  Tracer &operator=(const Tracer &other) = delete;
+  Tracer &operator=(Tracer &&other) = delete;
+
+  [[nodiscard]] auto now() const -> int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+  // Adds a finished zone to the calling thread's buffer. The name is kept
+  // as a pointer, so it has to outlive the tracer; literals do.
+  void record(const char *name, int64_t begin, int64_t end);
+
+  // Names the calling thread in written traces.
+  void set_thread_name(std::string name);
+
+  // Writes every buffered event and returns how many there were. Zones
+  // still open are left out.
+  auto write_chrome_trace(const std::filesystem::path &path) const
+      -> uint64_t;
+
+  [[nodiscard]] auto stats() const -> TraceStats;
+
+private:
+  struct Buffer;
+
+  Tracer();
+  ~Tracer();
+
+  auto buffer() -> Buffer &;
+
+  std::chrono::steady_clock::time_point start_;
+
+  // Guards the list of buffers and their names, not their events.
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+// Records the time from its construction to its destruction.
+class TraceZone {
+public:
+  explicit TraceZone(const char *name)
+      : name_(name), begin_(Tracer::get().now()) {}
+
+  TraceZone(const TraceZone &other) = delete;
+  TraceZone(TraceZone &&other) = delete;
+  TraceZone &operator=(const TraceZone &other) = delete;
+  TraceZone &operator=(TraceZone &&other) = delete;
+
+  ~TraceZone() {
+    auto &tracer = Tracer::get();
+    tracer.record(name_, begin_, tracer.now());
+  }
+
+private:
+  const char *name_;
+  int64_t begin_;
+};
+
+} // namespace mov
+
+#define MOV_TRACE_CONCAT_(a, b) a##b
+#define MOV_TRACE_CONCAT(a, b) MOV_TRACE_CONCAT_(a, b)
+
+// Traces the rest of the enclosing scope as a zone called `name`.
+#ifdef MOV_TRACING
+#define MOV_TRACE_ZONE(name)                                                  \
+  const ::mov::TraceZone MOV_TRACE_CONCAT(mov_trace_zone_, __LINE__)(name)
+#else
+#define MOV_TRACE_ZONE(name) static_cast<void>(0)
+#endif
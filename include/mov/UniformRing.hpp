@@ -0,0 +1,53 @@
+#pragma once
+
+#include <mov/VkAllocator.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+namespace mov {
+
+class UniformRing {
+public:
+  static constexpr vk::DeviceSize default_frame_capacity = 64 * 1024;
+
+  UniformRing(VkAllocator &allocator, uint32_t frame_count,
+              vk::DeviceSize frame_capacity = default_frame_capacity);
+
+  UniformRing(const UniformRing &other) = delete;
+  UniformRing(UniformRing &&other) = delete;
+  UniformRing &operator=(const UniformRing &other) = delete;
+  UniformRing &operator=(UniformRing &&other) = delete;
+
+  ~UniformRing() = default;
+
+  void begin_frame(uint32_t frame);
+
+  // Returns a pointer into persistently mapped memory and the dynamic offset
+  // to bind it with; write the data in place.
+  [[nodiscard]] auto allocate(vk::DeviceSize size)
+      -> std::tuple<void *, uint32_t>;
+
+  template <typename T> [[nodiscard]] auto allocate() {
+    const auto [data, offset] = allocate(sizeof(T));
+    return std::tuple<T *, uint32_t>{static_cast<T *>(data), offset};
+  }
+
+  [[nodiscard]] auto buffer() const { return buffer_; }
+
+  void destroy();
+
+private:
+  VkAllocator *allocator_;
+
+  vk::Buffer buffer_;
+  VkAllocation allocation_;
+
+  vk::DeviceSize alignment_;
+  vk::DeviceSize frame_capacity_;
+  uint32_t frame_count_;
+
+  vk::DeviceSize frame_begin_{0};
+  vk::DeviceSize cursor_{0};
+};
+
+} // namespace mov
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <mov/FreeList.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <vector>
+
+namespace mov {
+
+enum class MemoryCategory : uint32_t {
+  Geometry,
+  Textures,
+  Attachments,
+  Uniforms,
+  Staging,
+  Other,
+};
+
+constexpr size_t memory_category_count = 6;
+
+constexpr auto to_string(const MemoryCategory category) {
+  constexpr const char *names[memory_category_count] = {
+      "geometry", "textures", "attachments", "uniforms", "staging", "other"};
+  return names[static_cast<uint32_t>(category)];
+}
+
+using MemoryCategoryUsage = std::array<vk::DeviceSize, memory_category_count>;
+
+struct VkAllocation {
+  vk::DeviceMemory memory;
+  vk::DeviceSize offset{0};
+  vk::DeviceSize size{0};
+
+  void *mapped{nullptr};
+
+  uint32_t memory_type{0};
+  bool linear{true};
+  MemoryCategory category{MemoryCategory::Other};
+};
+
+struct VkAllocatorStats {
+  uint32_t block_count{0};
+  uint32_t allocation_count{0};
+  uint32_t free_range_count{0};
+
+  vk::DeviceSize reserved{0};
+  vk::DeviceSize used{0};
+  vk::DeviceSize largest_free{0};
+
+  [[nodiscard]] auto fragmentation() const {
+    const auto free = reserved - used;
+    return free == 0 ? 0.f
+                     : 1.f - static_cast<float>(largest_free) /
+                                 static_cast<float>(free);
+  }
+};
+
+class VkAllocator {
+public:
+  static constexpr vk::DeviceSize default_block_size = 64ull * 1024 * 1024;
+
+  VkAllocator(vk::Device device, vk::PhysicalDevice physical_device,
+              vk::DeviceSize block_size = default_block_size);
+
+  VkAllocator(const VkAllocator &other) = delete;
+  VkAllocator(VkAllocator &&other) = delete;
+  VkAllocator &operator=(const VkAllocator &other) = delete;
+  VkAllocator &operator=(VkAllocator &&other) = delete;
+
+  ~VkAllocator() = default;
+
+  [[nodiscard]] auto
+  allocate(const vk::MemoryRequirements &requirements,
+           vk::MemoryPropertyFlags properties,
+           MemoryCategory category = MemoryCategory::Other, bool linear = true)
+      -> VkAllocation;
+
+  void free(const VkAllocation &allocation);
+
+  [[nodiscard]] auto
+  create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage,
+                vk::MemoryPropertyFlags properties,
+                MemoryCategory category = MemoryCategory::Other)
+      -> std::tuple<vk::Buffer, VkAllocation>;
+
+  [[nodiscard]] auto
+  create_image(const vk::ImageCreateInfo &create_info,
+               vk::MemoryPropertyFlags properties,
+               MemoryCategory category = MemoryCategory::Other)
+      -> std::tuple<vk::Image, VkAllocation>;
+
+  void destroy_buffer(vk::Buffer buffer, const VkAllocation &allocation);
+  void destroy_image(vk::Image image, const VkAllocation &allocation);
+
+  [[nodiscard]] auto stats() const -> VkAllocatorStats;
+  [[nodiscard]] auto stats(uint32_t memory_type) const -> VkAllocatorStats;
+
+  // Bytes handed out per category (and the largest that ever was), and bytes
+  // reserved from the driver per memory heap.
+  [[nodiscard]] auto category_usage() const { return category_usage_; }
+  [[nodiscard]] auto category_peak() const { return category_peak_; }
+  [[nodiscard]] auto heap_usage(const uint32_t heap) const {
+    return heap_usage_[heap];
+  }
+
+  [[nodiscard]] auto memory_properties() const -> const auto & {
+    return memory_properties_;
+  }
+
+  [[nodiscard]] auto device() const { return device_; }
+  [[nodiscard]] auto physical_device() const { return physical_device_; }
+
+  void destroy();
+
+private:
+  struct Block {
+    vk::DeviceMemory memory;
+    FreeList ranges;
+    std::byte *mapped{nullptr};
+    uint32_t allocation_count{0};
+  };
+
+  // Buffers and optimally tiled images live in separate pools so neighbouring
+  // sub-allocations never have to be padded to bufferImageGranularity.
+  struct Pool {
+    std::vector<Block> blocks;
+  };
+
+  [[nodiscard]] auto pool_index(const uint32_t memory_type,
+                                const bool linear) const {
+    return memory_type * 2 + (linear ? 0 : 1);
+  }
+
+  [[nodiscard]] auto block_size_for(uint32_t memory_type) const
+      -> vk::DeviceSize;
+
+  auto create_block(uint32_t memory_type, vk::DeviceSize size) -> Block;
+  void release_block(uint32_t memory_type, const Block &block);
+
+  static void accumulate(VkAllocatorStats &stats, const Pool &pool);
+
+  vk::Device device_;
+  vk::PhysicalDevice physical_device_;
+  vk::PhysicalDeviceMemoryProperties memory_properties_;
+
+  vk::DeviceSize block_size_;
+
+  std::vector<Pool> pools_;
+
+  MemoryCategoryUsage category_usage_{};
+  MemoryCategoryUsage category_peak_{};
+  std::array<vk::DeviceSize, VK_MAX_MEMORY_HEAPS> heap_usage_{};
+};
+
+} // namespace mov
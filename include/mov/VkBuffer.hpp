@@ -1,6 +1,8 @@
 #pragma once
 
 #include <mov/Vertex.hpp>
+#include <mov/VkAllocator.hpp>
+#include <mov/VkUploader.hpp>
 
 #include <vulkan/vulkan.hpp>
 
@@ -12,24 +14,29 @@ class VkBufferProvider {
 public:
   VkBufferProvider() = default;
 
-  VkBufferProvider(const vk::Device device,
-                   const vk::PhysicalDevice physical_device,
-                   const vk::CommandPool command_pool, const vk::Queue queue)
-      : device_(device), physical_device_(physical_device),
-        command_pool_(command_pool), queue_(queue) {}
+  VkBufferProvider(VkAllocator &allocator, VkUploader &uploader)
+      : device_(allocator.device()), allocator_(&allocator),
+        uploader_(&uploader) {}
 
-  [[nodiscard]] auto create_buffer(vk::DeviceSize size,
-                                   vk::BufferUsageFlags usage,
-                                   vk::MemoryPropertyFlags properties) const
-      -> std::tuple<vk::Buffer, vk::DeviceMemory>;
+  [[nodiscard]] auto
+  create_buffer(vk::DeviceSize size, vk::BufferUsageFlags usage,
+                vk::MemoryPropertyFlags properties,
+                MemoryCategory category = MemoryCategory::Other) const
+      -> std::tuple<vk::Buffer, VkAllocation>;
 
-  auto copy_buffer(vk::Buffer src, vk::Buffer dst, vk::DeviceSize size) const;
+  void destroy_buffer(vk::Buffer buffer, const VkAllocation &allocation) const;
+
+  void copy_buffer(vk::Buffer src, vk::Buffer dst, vk::DeviceSize size) const;
+  void copy_buffer(vk::Buffer src, vk::Buffer dst,
+                   const vk::BufferCopy &region) const;
+
+  void upload(vk::Buffer dst, vk::DeviceSize offset, const void *data,
+              vk::DeviceSize size) const;
 
 private:
   vk::Device device_;
-  vk::PhysicalDevice physical_device_;
-  vk::CommandPool command_pool_;
-  vk::Queue queue_;
+  VkAllocator *allocator_{nullptr};
+  VkUploader *uploader_{nullptr};
 
   friend vk::Device device(const VkBufferProvider &provider) {
     return provider.device_;
@@ -47,31 +54,30 @@ public:
 
   VkBuffer(const VkBuffer &other) {
     this->buffer = other.buffer;
-    this->memory = other.memory;
+    this->allocation = other.allocation;
     this->provider_ = other.provider_;
   }
 
   VkBuffer(VkBuffer &&other) noexcept {
     this->buffer = other.buffer;
-    this->memory = other.memory;
+    this->allocation = other.allocation;
     this->provider_ = other.provider_;
   }
 
   VkBuffer &operator=(const VkBuffer &other) {
     this->buffer = other.buffer;
-    this->memory = other.memory;
+    this->allocation = other.allocation;
     this->provider_ = other.provider_;
 
     return *this;
   }
 
   [[nodiscard]] auto destroy() const {
-    provider_.device_.freeMemory(memory);
-    provider_.device_.destroyBuffer(buffer);
+    provider_.destroy_buffer(buffer, allocation);
   }
 
   vk::Buffer buffer;
-  vk::DeviceMemory memory;
+  VkAllocation allocation;
 
 private:
   VkBufferProvider provider_;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mov/VkAllocator.hpp>
+
 #include <vulkan/vulkan.hpp>
 
 namespace mov {
@@ -8,10 +10,11 @@ class VkImage {
 public:
   VkImage() = default;
 
-  VkImage(vk::Device device, vk::PhysicalDevice physical_device, uint32_t width,
-          uint32_t height, vk::Format format, vk::ImageTiling tiling,
+  VkImage(VkAllocator &allocator, uint32_t width, uint32_t height, vk::Format format, vk::ImageTiling tiling,
           vk::ImageAspectFlags aspect, vk::ImageUsageFlags usage,
-          vk::MemoryPropertyFlags properties);
+          vk::MemoryPropertyFlags properties,
+          MemoryCategory category = MemoryCategory::Textures,
+          uint32_t layers = 1);
 
   VkImage(const VkImage &other) = delete;
   VkImage(VkImage &&other) = delete;
@@ -19,25 +22,25 @@ public:
 
   VkImage &operator=(VkImage &&other) noexcept {
     this->image = other.image;
-    this->memory = other.memory;
+    this->allocation = other.allocation;
     this->image_view = other.image_view;
     this->sampler = other.sampler;
     this->width = other.width;
     this->height = other.height;
     this->device_ = other.device_;
+    this->allocator_ = other.allocator_;
 
     return *this;
   }
 
   auto destroy() const {
-    device_.freeMemory(memory);
     device_.destroySampler(sampler);
     device_.destroyImageView(image_view);
-    device_.destroyImage(image);
+    allocator_->destroy_image(image, allocation);
   }
 
   vk::Image image;
-  vk::DeviceMemory memory;
+  VkAllocation allocation;
 
   vk::ImageView image_view;
   vk::Sampler sampler;
@@ -48,12 +51,14 @@ public:
 private:
   static vk::ImageView create_view(vk::Device device, vk::Image image,
                                    vk::Format format,
-                                   vk::ImageAspectFlags aspect);
+                                   vk::ImageAspectFlags aspect,
+                                   uint32_t layers);
 
   static vk::Sampler create_sampler(vk::Device device,
                                     vk::PhysicalDevice physical_device);
 
   vk::Device device_;
+  VkAllocator *allocator_{nullptr};
 };
 
 }; // namespace mov
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <mov/VkAllocator.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace mov {
+
+struct VkUploadStats {
+  vk::DeviceSize bytes{0};
+  uint32_t copies{0};
+  uint32_t batches{0};
+
+  std::chrono::nanoseconds busy{0};
+
+  [[nodiscard]] auto megabytes_per_second() const {
+    const auto seconds = std::chrono::duration<double>(busy).count();
+    return seconds > 0 ? static_cast<double>(bytes) / seconds / 1'000'000 : 0.;
+  }
+};
+
+class VkUploader {
+public:
+  static constexpr vk::DeviceSize default_ring_size = 16ull * 1024 * 1024;
+  static constexpr uint32_t batch_count = 4;
+
+  VkUploader(VkAllocator &allocator, uint32_t queue_family_index,
+             vk::Queue queue, vk::DeviceSize ring_size = default_ring_size)
+      : VkUploader(allocator, queue_family_index, queue, queue_family_index,
+                   queue, ring_size) {}
+
+  // Uploads run on the transfer queue; when it belongs to another family the
+  // written ranges are released to, and acquired by, the graphics family.
+  VkUploader(VkAllocator &allocator, uint32_t transfer_family_index,
+             vk::Queue transfer_queue, uint32_t graphics_family_index,
+             vk::Queue graphics_queue,
+             vk::DeviceSize ring_size = default_ring_size);
+
+  VkUploader(const VkUploader &other) = delete;
+  VkUploader(VkUploader &&other) = delete;
+  VkUploader &operator=(const VkUploader &other) = delete;
+  VkUploader &operator=(VkUploader &&other) = delete;
+
+  ~VkUploader() = default;
+
+  void upload(vk::Buffer dst, vk::DeviceSize dst_offset, const void *data,
+              vk::DeviceSize size);
+
+  void upload(vk::Image dst, vk::Extent2D extent, vk::DeviceSize texel_size,
+              const void *data, vk::ImageLayout final_layout,
+              vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor);
+
+  // Device-to-device copies between buffers the graphics family owns; they
+  // are recorded after this batch's uploads have been acquired.
+  void copy(vk::Buffer src, vk::Buffer dst, const vk::BufferCopy &region);
+
+  auto flush() -> uint64_t;
+
+  void wait(uint64_t ticket);
+  void wait_idle();
+
+  [[nodiscard]] auto completed() const { return completed_; }
+  [[nodiscard]] auto stats() const { return stats_; }
+  [[nodiscard]] auto dedicated() const { return dedicated_; }
+
+  void destroy();
+
+private:
+  struct Batch {
+    vk::CommandBuffer commands;
+    vk::CommandBuffer acquire;
+    vk::Semaphore semaphore;
+    vk::Fence fence;
+
+    uint64_t ticket{0};
+    vk::DeviceSize ring_end{0};
+    vk::DeviceSize bytes{0};
+    uint32_t copies{0};
+
+    std::chrono::steady_clock::time_point started;
+    bool pending{false};
+  };
+
+  struct Copy {
+    vk::Buffer src;
+    vk::Buffer dst;
+    vk::BufferCopy region;
+  };
+
+  auto begin_batch() -> Batch &;
+  auto reserve(vk::DeviceSize size) -> vk::DeviceSize;
+
+  void retire(Batch &batch, bool block);
+  void poll();
+
+  vk::Device device_;
+  VkAllocator *allocator_;
+
+  uint32_t transfer_family_;
+  uint32_t graphics_family_;
+  vk::Queue transfer_queue_;
+  vk::Queue graphics_queue_;
+  bool dedicated_;
+
+  vk::CommandPool transfer_pool_;
+  vk::CommandPool graphics_pool_;
+
+  vk::Buffer ring_;
+  VkAllocation ring_allocation_;
+  vk::DeviceSize ring_size_;
+
+  // Monotonic byte positions; the physical offset is position % ring_size_.
+  vk::DeviceSize head_{0};
+  vk::DeviceSize tail_{0};
+
+  std::array<Batch, batch_count> batches_;
+  uint32_t current_{0};
+  bool recording_{false};
+
+  std::vector<vk::BufferMemoryBarrier> buffer_acquires_;
+  std::vector<vk::ImageMemoryBarrier> image_acquires_;
+  std::vector<Copy> copies_;
+
+  uint64_t next_ticket_{1};
+  uint64_t completed_{0};
+
+  VkUploadStats stats_;
+  std::chrono::steady_clock::time_point busy_until_;
+};
+
+} // namespace mov
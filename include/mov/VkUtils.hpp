@@ -2,8 +2,29 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <vector>
+
 namespace mov {
+
+struct QueueFamilies {
+  uint32_t graphics{~0u};
+  uint32_t transfer{~0u};
+  uint32_t compute{~0u};
+
+  [[nodiscard]] auto has_dedicated_transfer() const {
+    return transfer != graphics;
+  }
+  [[nodiscard]] auto has_async_compute() const { return compute != graphics; }
+};
+
 extern uint32_t find_memory_type(vk::PhysicalDevice device,
                                  uint32_t type_filter,
                                  vk::MemoryPropertyFlags properties);
-}
\ No newline at end of file
+
+extern vk::Format
+find_supported_format(vk::PhysicalDevice device,
+                      const std::vector<vk::Format> &candidates,
+                      vk::ImageTiling tiling, vk::FormatFeatureFlags features);
+
+extern QueueFamilies find_queue_families(vk::PhysicalDevice device);
+}
@@ -0,0 +1,73 @@
+#include <mov/Attachments.hpp>
+#include <mov/VkUtils.hpp>
+
+#include <cmath>
+
+namespace mov {
+
+vk::Format find_depth_format(const vk::PhysicalDevice physical_device,
+                             const float near_distance,
+                             const float far_distance, const float tolerance) {
+  // d = f (z - n) / (z (f - n)), so one step of an N bit depth buffer covers
+  // z^2 (f - n) / (f n 2^N) at distance z, which is worst at the far plane.
+  const auto relative_step = [&](const int bits) {
+    return (far_distance - near_distance) /
+           (near_distance * std::exp2(static_cast<float>(bits)));
+  };
+
+  std::vector<vk::Format> candidates;
+  if (relative_step(16) <= tolerance)
+    candidates.push_back(vk::Format::eD16Unorm);
+
+  candidates.insert(candidates.end(),
+                    {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint,
+                     vk::Format::eD24UnormS8Uint});
+
+  return find_supported_format(
+      physical_device, candidates, vk::ImageTiling::eOptimal,
+      vk::FormatFeatureFlagBits::eDepthStencilAttachment);
+}
+
+static auto
+has_lazily_allocated_memory(const vk::PhysicalDeviceMemoryProperties &memory) {
+  constexpr auto flags = vk::MemoryPropertyFlagBits::eDeviceLocal |
+                         vk::MemoryPropertyFlagBits::eLazilyAllocated;
+
+  for (uint32_t i = 0; i < memory.memoryTypeCount; i++)
+    if ((memory.memoryTypes[i].propertyFlags & flags) == flags)
+      return true;
+
+  return false;
+}
+
+TransientAttachments::TransientAttachments(
+    VkAllocator &allocator, const uint32_t width, const uint32_t height,
+    const vk::Format format, const vk::ImageAspectFlags aspect,
+    const vk::ImageUsageFlags usage, const uint32_t count,
+    const uint32_t layers)
+    : format_(format), lazily_allocated_(has_lazily_allocated_memory(
+                           allocator.memory_properties())),
+      images_(count) {
+  // Desktop GPUs expose no lazily allocated memory type; the attachments
+  // then simply live in device local memory.
+  const auto properties =
+      lazily_allocated_ ? vk::MemoryPropertyFlagBits::eDeviceLocal |
+                              vk::MemoryPropertyFlagBits::eLazilyAllocated
+                        : vk::MemoryPropertyFlags(
+                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  for (auto &image : images_)
+    image = VkImage(allocator, width, height, format,
+                    vk::ImageTiling::eOptimal, aspect,
+                    usage | vk::ImageUsageFlagBits::eTransientAttachment,
+                    properties, MemoryCategory::Attachments, layers);
+}
+
+void TransientAttachments::destroy() {
+  for (const auto &image : images_)
+    image.destroy();
+
+  images_.clear();
+}
+
+} // namespace mov
@@ -0,0 +1,99 @@
+#include <mov/Bounds.hpp>
+
+namespace mov {
+
+auto BoundingBox::transformed(const glm::mat4 &model) const -> BoundingBox {
+  // Arvo's method: each axis of the model matrix widens the box by its
+  // smaller and larger product with the source extent.
+  glm::vec3 new_min(model[3]);
+  glm::vec3 new_max = new_min;
+
+  for (int i = 0; i < 3; i++) {
+    const auto a = glm::vec3(model[i]) * min[i];
+    const auto b = glm::vec3(model[i]) * max[i];
+
+    new_min += glm::min(a, b);
+    new_max += glm::max(a, b);
+  }
+
+  return {new_min, new_max};
+}
+
+namespace {
+
+template <typename T, typename Position>
+auto bounding_box(const std::vector<T> &vertices, const Position position)
+    -> BoundingBox {
+  if (vertices.empty())
+    return {};
+
+  BoundingBox box{vertices.front().*position, vertices.front().*position};
+
+  for (const auto &vertex : vertices) {
+    box.min = glm::min(box.min, vertex.*position);
+    box.max = glm::max(box.max, vertex.*position);
+  }
+
+  return box;
+}
+
+template <typename T, typename Position>
+auto bounding_sphere(const std::vector<T> &vertices, const Position position)
+    -> BoundingSphere {
+  if (vertices.empty())
+    return {};
+
+  const auto center = bounding_box(vertices, position).center();
+
+  float radius = 0.f;
+  for (const auto &vertex : vertices)
+    radius = glm::max(radius, glm::length(vertex.*position - center));
+
+  return {center, radius};
+}
+
+} // namespace
+
+BoundingBox compute_bounding_box(const std::vector<Vertex> &vertices) {
+  return bounding_box(vertices, &Vertex::pos);
+}
+
+BoundingBox
+compute_bounding_box(const std::vector<VertexAttributes> &vertices) {
+  return bounding_box(vertices, &VertexAttributes::position);
+}
+
+BoundingSphere compute_bounding_sphere(const std::vector<Vertex> &vertices) {
+  return bounding_sphere(vertices, &Vertex::pos);
+}
+
+BoundingSphere
+compute_bounding_sphere(const std::vector<VertexAttributes> &vertices) {
+  return bounding_sphere(vertices, &VertexAttributes::position);
+}
+
+auto Frustum::from_matrix(const glm::mat4 &view_projection) -> Frustum {
+  const auto row = [&](const int i) {
+    return glm::vec4(view_projection[0][i], view_projection[1][i],
+                     view_projection[2][i], view_projection[3][i]);
+  };
+
+  Frustum frustum;
+  frustum.planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                    row(3) - row(1), row(2),          row(3) - row(2)};
+
+  for (auto &plane : frustum.planes)
+    plane /= glm::length(glm::vec3(plane));
+
+  return frustum;
+}
+
+auto Frustum::intersects(const BoundingSphere &sphere) const -> bool {
+  for (const auto &plane : planes)
+    if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+      return false;
+
+  return true;
+}
+
+} // namespace mov
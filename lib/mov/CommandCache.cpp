@@ -0,0 +1,61 @@
+#include <mov/CommandCache.hpp>
+
+namespace mov {
+
+CommandCache::CommandCache(const vk::Device device,
+                           const uint32_t queue_family_index)
+    : device_(device),
+      command_pool_(device.createCommandPool(
+          {vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+           queue_family_index})) {}
+
+void CommandCache::begin_frame() { frame_stats_ = {}; }
+
+auto CommandCache::get(const CommandCacheKey &key,
+                       const vk::CommandBufferInheritanceInfo &inheritance,
+                       const Record &record) -> vk::CommandBuffer {
+  auto &entry = entries_[key.framebuffer];
+
+  if (entry.recorded && entry.key == key) {
+    stats_.hits++;
+    frame_stats_.hits++;
+    return entry.commands;
+  }
+
+  if (!entry.commands)
+    entry.commands = device_.allocateCommandBuffers(
+        vk::CommandBufferAllocateInfo()
+            .setCommandPool(command_pool_)
+            .setLevel(vk::CommandBufferLevel::eSecondary)
+            .setCommandBufferCount(1))[0];
+
+  entry.commands.reset();
+  entry.commands.begin(
+      vk::CommandBufferBeginInfo()
+          .setFlags(vk::CommandBufferUsageFlagBits::eRenderPassContinue)
+          .setPInheritanceInfo(&inheritance));
+
+  record(entry.commands);
+
+  entry.commands.end();
+
+  entry.key = key;
+  entry.recorded = true;
+
+  stats_.records++;
+  frame_stats_.records++;
+
+  return entry.commands;
+}
+
+void CommandCache::invalidate() {
+  for (auto &[framebuffer, entry] : entries_)
+    entry.recorded = false;
+}
+
+void CommandCache::destroy() {
+  device_.destroyCommandPool(command_pool_);
+  entries_.clear();
+}
+
+} // namespace mov
@@ -0,0 +1,69 @@
+#include <mov/DynamicResolution.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mov {
+
+DynamicResolution::DynamicResolution(
+    const DynamicResolutionSettings &settings, const uint32_t frame_count)
+    : settings_(settings), scale_(settings.max_scale),
+      slot_scales_(std::max(frame_count, 1u), scale_) {
+  stats_.min_scale = scale_;
+}
+
+auto DynamicResolution::update(const uint32_t slot,
+                               const std::chrono::nanoseconds gpu_time)
+    -> float {
+  auto &slot_scale = slot_scales_[slot % slot_scales_.size()];
+
+  if (gpu_time.count() <= 0) {
+    slot_scale = scale_;
+    return scale_;
+  }
+
+  if (slot_scale != scale_) {
+    stats_.skipped++;
+    slot_scale = scale_;
+    return scale_;
+  }
+
+  const auto time = std::chrono::duration<float, std::milli>(gpu_time);
+  const auto target = settings_.target;
+
+  if (time > target * (1.f + settings_.hysteresis)) {
+    // GPU time follows the pixel count, which goes with the square of the
+    // scale.
+    scale_ *= std::sqrt(target / time);
+    stats_.shrinks++;
+  } else if (time < target * (1.f - settings_.hysteresis) &&
+             scale_ < settings_.max_scale) {
+    scale_ += settings_.grow_step;
+    stats_.grows++;
+  }
+
+  scale_ = std::clamp(scale_, settings_.min_scale, settings_.max_scale);
+
+  stats_.samples++;
+  stats_.min_scale = std::min(stats_.min_scale, scale_);
+
+  history_.push_back({time, scale_});
+  while (history_.size() > settings_.history_size)
+    history_.pop_front();
+
+  slot_scale = scale_;
+  return scale_;
+}
+
+auto DynamicResolution::extent(const uint32_t width,
+                               const uint32_t height) const -> vk::Extent2D {
+  const auto scaled = [&](const uint32_t size) {
+    return std::clamp(
+        static_cast<uint32_t>(std::lround(static_cast<float>(size) * scale_)),
+        1u, size);
+  };
+
+  return {scaled(width), scaled(height)};
+}
+
+} // namespace mov
@@ -0,0 +1,137 @@
+#include <mov/FrameScheduler.hpp>
+#include <mov/Tracer.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace mov {
+
+FrameScheduler::FrameScheduler(const vk::Device device,
+                               const uint32_t queue_family_index,
+                               const uint32_t frame_count,
+                               const float timestamp_period)
+    : device_(device), timestamp_period_(timestamp_period),
+      frames_(frame_count) {
+  for (auto &frame : frames_) {
+    frame.pool = device_.createCommandPool(
+        {vk::CommandPoolCreateFlagBits::eTransient, queue_family_index});
+    frame.fence = device_.createFence({vk::FenceCreateFlagBits::eSignaled});
+  }
+
+  // A start and an end timestamp per slot.
+  if (timing())
+    query_pool_ = device_.createQueryPool(
+        vk::QueryPoolCreateInfo()
+            .setQueryType(vk::QueryType::eTimestamp)
+            .setQueryCount(frame_count * 2));
+}
+
+auto FrameScheduler::begin_frame(const uint64_t frame) -> uint32_t {
+  slot_ = static_cast<uint32_t>(frame % frames_.size());
+  auto &current = frames_[slot_];
+
+  const auto started = std::chrono::steady_clock::now();
+
+  {
+    MOV_TRACE_ZONE("wait for GPU");
+    if (device_.waitForFences(current.fence, true,
+                              std::numeric_limits<uint64_t>::max()) !=
+        vk::Result::eSuccess)
+      throw std::runtime_error("Failed to wait for frame fence!");
+  }
+
+  last_gpu_wait_ = std::chrono::steady_clock::now() - started;
+  stats_.gpu_wait += last_gpu_wait_;
+  stats_.max_gpu_wait = std::max(stats_.max_gpu_wait, last_gpu_wait_);
+
+  last_gpu_time_ = std::chrono::nanoseconds(0);
+
+  if (current.timed) {
+    uint64_t timestamps[2];
+
+    // The fence has signalled, so the results are available without waiting.
+    if (device_.getQueryPoolResults(query_pool_, slot_ * 2, 2,
+                                    sizeof timestamps, timestamps,
+                                    sizeof(uint64_t),
+                                    vk::QueryResultFlagBits::e64) ==
+        vk::Result::eSuccess) {
+      last_gpu_time_ = std::chrono::nanoseconds(static_cast<int64_t>(
+          static_cast<double>(timestamps[1] - timestamps[0]) *
+          timestamp_period_));
+      stats_.gpu_time += last_gpu_time_;
+      stats_.timed_frames++;
+    }
+
+    current.timed = false;
+  }
+
+  device_.resetCommandPool(current.pool);
+  current.used = 0;
+
+  // Opens the frame's submit, ahead of any command buffer handed out.
+  if (timing()) {
+    const auto commands = command_buffer();
+
+    commands.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    commands.resetQueryPool(query_pool_, slot_ * 2, 2);
+    commands.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe,
+                            query_pool_, slot_ * 2);
+    commands.end();
+  }
+
+  return slot_;
+}
+
+auto FrameScheduler::command_buffer() -> vk::CommandBuffer {
+  auto &current = frames_[slot_];
+
+  if (current.used == current.buffers.size())
+    current.buffers.push_back(device_.allocateCommandBuffers(
+        vk::CommandBufferAllocateInfo()
+            .setCommandPool(current.pool)
+            .setLevel(vk::CommandBufferLevel::ePrimary)
+            .setCommandBufferCount(1))[0]);
+
+  return current.buffers[current.used++];
+}
+
+void FrameScheduler::submit(const vk::Queue queue) {
+  // Closes the frame's submit once everything before it has finished.
+  if (timing()) {
+    const auto commands = command_buffer();
+
+    commands.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    commands.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe,
+                            query_pool_, slot_ * 2 + 1);
+    commands.end();
+  }
+
+  auto &current = frames_[slot_];
+  current.timed = timing();
+
+  device_.resetFences(current.fence);
+
+  queue.submit(vk::SubmitInfo()
+                   .setCommandBufferCount(current.used)
+                   .setPCommandBuffers(current.buffers.data()),
+               current.fence);
+
+  stats_.frames++;
+  stats_.command_buffers += current.used;
+}
+
+void FrameScheduler::destroy() {
+  for (const auto &frame : frames_) {
+    device_.destroyFence(frame.fence);
+    device_.destroyCommandPool(frame.pool);
+  }
+
+  frames_.clear();
+
+  if (query_pool_)
+    device_.destroyQueryPool(query_pool_);
+}
+
+} // namespace mov
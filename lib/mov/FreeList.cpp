@@ -0,0 +1,117 @@
+#include <mov/FreeList.hpp>
+
+#include <algorithm>
+
+namespace mov {
+
+auto FreeList::allocate(const Size size, const Size alignment)
+    -> std::optional<Size> {
+  if (size == 0)
+    return std::nullopt;
+
+  auto best = free_.end();
+  Size best_waste = ~Size{0};
+
+  for (auto it = free_.begin(); it != free_.end(); ++it) {
+    const auto aligned = align_up(it->offset, alignment);
+    const auto padding = aligned - it->offset;
+
+    if (padding + size > it->size)
+      continue;
+
+    if (const auto waste = it->size - size - padding; waste < best_waste) {
+      best = it;
+      best_waste = waste;
+
+      if (waste == 0)
+        break;
+    }
+  }
+
+  if (best == free_.end())
+    return std::nullopt;
+
+  return take(best, size, alignment);
+}
+
+auto FreeList::allocate_below(const Size limit, const Size size,
+                              const Size alignment) -> std::optional<Size> {
+  if (size == 0)
+    return std::nullopt;
+
+  for (auto it = free_.begin(); it != free_.end() && it->offset < limit;
+       ++it) {
+    const auto aligned = align_up(it->offset, alignment);
+
+    if (aligned + size <= it->offset + it->size && aligned + size <= limit)
+      return take(it, size, alignment);
+  }
+
+  return std::nullopt;
+}
+
+auto FreeList::take(const std::vector<Range>::iterator it, const Size size,
+                    const Size alignment) -> Size {
+  const auto range = *it;
+  const auto aligned = align_up(range.offset, alignment);
+  const auto tail = range.offset + range.size - (aligned + size);
+
+  // Alignment padding stays in the list so it can be reused by smaller
+  // allocations with looser alignment.
+  if (aligned != range.offset) {
+    it->size = aligned - range.offset;
+
+    if (tail > 0)
+      free_.insert(it + 1, {aligned + size, tail});
+  } else if (tail > 0) {
+    it->offset = aligned + size;
+    it->size = tail;
+  } else {
+    free_.erase(it);
+  }
+
+  used_ += size;
+
+  return aligned;
+}
+
+void FreeList::free(const Size offset, const Size size) {
+  if (size == 0)
+    return;
+
+  auto next = std::ranges::lower_bound(free_, offset, {}, &Range::offset);
+
+  if (next != free_.begin()) {
+    if (const auto prev = next - 1; prev->offset + prev->size == offset) {
+      prev->size += size;
+
+      if (next != free_.end() && offset + size == next->offset) {
+        prev->size += next->size;
+        free_.erase(next);
+      }
+
+      used_ -= size;
+      return;
+    }
+  }
+
+  if (next != free_.end() && offset + size == next->offset) {
+    next->offset = offset;
+    next->size += size;
+  } else {
+    free_.insert(next, {offset, size});
+  }
+
+  used_ -= size;
+}
+
+auto FreeList::largest_free() const -> Size {
+  Size largest = 0;
+
+  for (const auto &range : free_)
+    largest = std::max(largest, range.size);
+
+  return largest;
+}
+
+} // namespace mov
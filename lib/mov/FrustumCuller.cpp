@@ -0,0 +1,105 @@
+#include <mov/FrustumCuller.hpp>
+
+#if defined __SSE2__ || defined _M_X64 ||                                      \
+    (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define MOV_FRUSTUM_CULLER_SSE
+#include <emmintrin.h>
+#endif
+
+#include <bit>
+
+namespace mov {
+
+void FrustumCuller::clear() {
+  x_.clear();
+  y_.clear();
+  z_.clear();
+  radius_.clear();
+
+  count_ = 0;
+}
+
+auto FrustumCuller::add(const BoundingSphere &sphere) -> uint32_t {
+  if (count_ % lane_count == 0) {
+    x_.resize(count_ + lane_count, 0.f);
+    y_.resize(count_ + lane_count, 0.f);
+    z_.resize(count_ + lane_count, 0.f);
+    radius_.resize(count_ + lane_count, 0.f);
+  }
+
+  x_[count_] = sphere.center.x;
+  y_[count_] = sphere.center.y;
+  z_[count_] = sphere.center.z;
+  radius_[count_] = sphere.radius;
+
+  return count_++;
+}
+
+void FrustumCuller::cull(const Frustum *frusta, const uint32_t frustum_count,
+                         std::vector<uint32_t> &visible) {
+  const auto started = std::chrono::steady_clock::now();
+  const auto visible_before = visible.size();
+
+#ifdef MOV_FRUSTUM_CULLER_SSE
+  struct PlaneLanes {
+    __m128 x, y, z, w;
+  };
+
+  // Every plane component broadcast across the lanes once, up front.
+  std::vector<PlaneLanes> planes;
+  planes.reserve(frustum_count * 6);
+  for (uint32_t f = 0; f < frustum_count; f++)
+    for (const auto &plane : frusta[f].planes)
+      planes.push_back({_mm_set1_ps(plane.x), _mm_set1_ps(plane.y),
+                        _mm_set1_ps(plane.z), _mm_set1_ps(plane.w)});
+
+  for (uint32_t base = 0; base < count_; base += lane_count) {
+    const auto x = _mm_loadu_ps(x_.data() + base);
+    const auto y = _mm_loadu_ps(y_.data() + base);
+    const auto z = _mm_loadu_ps(z_.data() + base);
+    const auto negative_radius =
+        _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius_.data() + base));
+
+    auto any_inside = _mm_setzero_ps();
+
+    for (uint32_t f = 0; f < frustum_count; f++) {
+      auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+      for (uint32_t p = 0; p < 6; p++) {
+        const auto &plane = planes[f * 6 + p];
+        const auto distance = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(plane.x, x), _mm_mul_ps(plane.y, y)),
+            _mm_add_ps(_mm_mul_ps(plane.z, z), plane.w));
+
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+      }
+
+      any_inside = _mm_or_ps(any_inside, inside);
+    }
+
+    for (auto mask = static_cast<uint32_t>(_mm_movemask_ps(any_inside));
+         mask != 0; mask &= mask - 1) {
+      const auto index = base + static_cast<uint32_t>(std::countr_zero(mask));
+      if (index < count_)
+        visible.push_back(index);
+    }
+  }
+#else
+  for (uint32_t i = 0; i < count_; i++) {
+    const BoundingSphere sphere{{x_[i], y_[i], z_[i]}, radius_[i]};
+
+    for (uint32_t f = 0; f < frustum_count; f++) {
+      if (frusta[f].intersects(sphere)) {
+        visible.push_back(i);
+        break;
+      }
+    }
+  }
+#endif
+
+  stats_.tested += count_;
+  stats_.visible += visible.size() - visible_before;
+  stats_.busy += std::chrono::steady_clock::now() - started;
+}
+
+} // namespace mov
@@ -11,8 +11,9 @@ void GameObject::draw(const vk::CommandBuffer commands,
 void GameObject::draw(const vk::CommandBuffer commands,
                       const vk::PipelineLayout pipeline,
                       const glm::mat4 matrix) {
-  for (auto &mesh : meshes_) {
-    PushConstants push_constants{matrix};
+  for (const auto &chain : meshes_) {
+    const auto &mesh = chain.current();
+    PushConstants push_constants{matrix * mesh.decode_matrix()};
 
     commands.pushConstants(pipeline, vk::ShaderStageFlagBits::eVertex, 0,
                            sizeof PushConstants, &push_constants);
@@ -21,9 +22,63 @@ void GameObject::draw(const vk::CommandBuffer commands,
   }
 }
 
+void GameObject::batch(InstanceBatcher &batcher) {
+  batch(batcher, transform.matrix());
+}
+
+void GameObject::batch(InstanceBatcher &batcher, const glm::mat4 matrix) {
+  for (const auto &chain : meshes_)
+    batcher.add(chain.current(), matrix);
+}
+
+void GameObject::submit(GpuCuller &culler) {
+  submit(culler, transform.matrix());
+}
+
+void GameObject::submit(GpuCuller &culler, const glm::mat4 matrix) {
+  for (const auto &chain : meshes_)
+    culler.add(chain.current(), matrix);
+}
+
+void GameObject::select_lod(const LodView &view) {
+  select_lod(view, transform.matrix());
+}
+
+void GameObject::select_lod(const LodView &view, const glm::mat4 matrix) {
+  for (auto &chain : meshes_) {
+    const auto local = chain.levels().front().mesh.bounding_sphere();
+    const auto world = local.transformed(matrix);
+
+    // Distance to the nearest point of the bounds, where the error shows
+    // the most.
+    const auto distance =
+        glm::length(world.center - view.position) - world.radius;
+    const auto scale = local.radius > 0.f ? world.radius / local.radius : 1.f;
+
+    chain.select(view, distance, scale);
+  }
+}
+
+auto GameObject::bounding_sphere() -> BoundingSphere {
+  return bounding_sphere(transform.matrix());
+}
+
+auto GameObject::bounding_sphere(const glm::mat4 matrix) const
+    -> BoundingSphere {
+  return bounds_.transformed(matrix);
+}
+
+auto GameObject::bounding_box() -> BoundingBox {
+  return bounding_box(transform.matrix());
+}
+
+auto GameObject::bounding_box(const glm::mat4 matrix) const -> BoundingBox {
+  return box_.transformed(matrix);
+}
+
 void GameObject::destroy() {
-  for (auto &mesh : meshes_)
-    mesh.destroy();
+  for (const auto &chain : meshes_)
+    chain.destroy();
 }
 
 }; // namespace mov
\ No newline at end of file
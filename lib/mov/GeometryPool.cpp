@@ -0,0 +1,193 @@
+#include <mov/GeometryPool.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace mov {
+
+GeometryPool::GeometryPool(const VkBufferProvider provider,
+                           const vk::DeviceSize vertex_capacity,
+                           const vk::DeviceSize index_capacity,
+                           const uint32_t frame_latency)
+    : provider_(provider), vertex_ranges_(vertex_capacity),
+      index_ranges_(index_capacity), frame_latency_(frame_latency) {
+  std::tie(vertex_buffer_, vertex_allocation_) = provider_.create_buffer(
+      vertex_capacity,
+      vk::BufferUsageFlagBits::eVertexBuffer |
+          vk::BufferUsageFlagBits::eTransferSrc |
+          vk::BufferUsageFlagBits::eTransferDst,
+      vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Geometry);
+
+  std::tie(index_buffer_, index_allocation_) = provider_.create_buffer(
+      index_capacity,
+      vk::BufferUsageFlagBits::eIndexBuffer |
+          vk::BufferUsageFlagBits::eTransferSrc |
+          vk::BufferUsageFlagBits::eTransferDst,
+      vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Geometry);
+}
+
+auto GeometryPool::allocate(const void *vertices, const uint32_t vertex_count,
+                            const uint32_t vertex_stride, const void *indices,
+                            const uint32_t index_count,
+                            const vk::IndexType index_type) -> Handle {
+  const auto vertex_size =
+      static_cast<vk::DeviceSize>(vertex_count) * vertex_stride;
+  const vk::DeviceSize index_stride = mov::index_size(index_type);
+  const auto index_size = index_count * index_stride;
+
+  // Vertex ranges are aligned to their own stride so vertexOffset stays an
+  // exact element index into the shared buffer.
+  const auto vertex_offset =
+      vertex_ranges_.allocate(vertex_size, vertex_stride);
+  if (!vertex_offset)
+    throw std::runtime_error("Geometry pool is out of vertex memory!");
+
+  // Likewise firstIndex for the entry's index type.
+  const auto index_offset = index_ranges_.allocate(index_size, index_stride);
+  if (!index_offset) {
+    vertex_ranges_.free(*vertex_offset, vertex_size);
+    throw std::runtime_error("Geometry pool is out of index memory!");
+  }
+
+  provider_.upload(vertex_buffer_, *vertex_offset, vertices, vertex_size);
+  provider_.upload(index_buffer_, *index_offset, indices, index_size);
+
+  Handle handle;
+  if (free_handles_.empty()) {
+    handle = static_cast<Handle>(entries_.size());
+    entries_.emplace_back();
+  } else {
+    handle = free_handles_.back();
+    free_handles_.pop_back();
+  }
+
+  entries_[handle] = {*vertex_offset, vertex_size, vertex_stride, *index_offset,
+                      index_size, index_count, index_type, true};
+
+  return handle;
+}
+
+void GeometryPool::free(const Handle handle) {
+  if (handle >= entries_.size() || !entries_[handle].live)
+    return;
+
+  auto &entry = entries_[handle];
+
+  retire(true, entry.vertex_offset, entry.vertex_size);
+  retire(false, entry.index_offset, entry.index_size);
+
+  entry.live = false;
+  free_handles_.push_back(handle);
+}
+
+void GeometryPool::retire(const bool vertex, const vk::DeviceSize offset,
+                          const vk::DeviceSize size) {
+  retired_.push_back({offset, size, vertex, frame_});
+}
+
+auto GeometryPool::defragment(const uint64_t frame,
+                              const vk::DeviceSize byte_budget)
+    -> vk::DeviceSize {
+  frame_ = frame;
+
+  std::erase_if(retired_, [this](const Retired &range) {
+    if (range.frame + frame_latency_ > frame_)
+      return false;
+
+    (range.vertex ? vertex_ranges_ : index_ranges_)
+        .free(range.offset, range.size);
+    return true;
+  });
+
+  const auto moved = compact(true, byte_budget);
+
+  return moved + compact(false, byte_budget - moved);
+}
+
+auto GeometryPool::compact(const bool vertex, const vk::DeviceSize byte_budget)
+    -> vk::DeviceSize {
+  auto &ranges = vertex ? vertex_ranges_ : index_ranges_;
+  const auto buffer = vertex ? vertex_buffer_ : index_buffer_;
+
+  // All free space in one piece: nothing would fit that does not fit now.
+  if (ranges.largest_free() == ranges.capacity() - ranges.used())
+    return 0;
+
+  const auto offset_of = [vertex](Entry *entry) -> vk::DeviceSize & {
+    return vertex ? entry->vertex_offset : entry->index_offset;
+  };
+
+  std::vector<Entry *> live;
+  for (auto &entry : entries_)
+    if (entry.live)
+      live.push_back(&entry);
+
+  // The highest ranges are the ones holding the free space apart.
+  std::ranges::sort(live, std::greater{}, offset_of);
+
+  vk::DeviceSize moved = 0;
+
+  for (auto *entry : live) {
+    auto &offset = offset_of(entry);
+    const auto size = vertex ? entry->vertex_size : entry->index_size;
+    const vk::DeviceSize alignment =
+        vertex ? entry->vertex_stride : index_size(entry->index_type);
+
+    if (moved + size > byte_budget)
+      continue;
+
+    const auto target = ranges.allocate_below(offset, size, alignment);
+    if (!target)
+      continue;
+
+    provider_.copy_buffer(buffer, buffer,
+                          vk::BufferCopy(offset, *target, size));
+    retire(vertex, offset, size);
+
+    offset = *target;
+    moved += size;
+  }
+
+  defragmented_ += moved;
+
+  return moved;
+}
+
+void GeometryPool::bind(const vk::CommandBuffer command_buffer) const {
+  constexpr vk::DeviceSize offsets[] = {0};
+
+  command_buffer.bindVertexBuffers(0, 1, &vertex_buffer_, offsets);
+  command_buffer.bindIndexBuffer(index_buffer_, 0, vk::IndexType::eUint32);
+}
+
+void GeometryPool::bind_indices(const vk::CommandBuffer command_buffer,
+                                const vk::IndexType index_type) const {
+  command_buffer.bindIndexBuffer(index_buffer_, 0, index_type);
+}
+
+auto GeometryPool::stats() const -> GeometryStats {
+  vk::DeviceSize retired = 0;
+  for (const auto &range : retired_)
+    retired += range.size;
+
+  return {static_cast<uint32_t>(entries_.size() - free_handles_.size()),
+          vertex_ranges_.capacity(),
+          vertex_ranges_.used(),
+          vertex_ranges_.largest_free(),
+          index_ranges_.capacity(),
+          index_ranges_.used(),
+          index_ranges_.largest_free(),
+          retired,
+          defragmented_};
+}
+
+void GeometryPool::destroy() {
+  provider_.destroy_buffer(vertex_buffer_, vertex_allocation_);
+  provider_.destroy_buffer(index_buffer_, index_allocation_);
+
+  entries_.clear();
+  free_handles_.clear();
+  retired_.clear();
+}
+
+} // namespace mov
@@ -0,0 +1,369 @@
+#include <mov/FreeList.hpp>
+#include <mov/GpuCuller.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace mov {
+
+GpuCuller::GpuCuller(VkAllocator &allocator, PipelineCache &pipeline_cache,
+                     const vk::ShaderModule cull_shader,
+                     const uint32_t frame_count,
+                     const bool draw_indirect_count,
+                     const bool multi_draw_indirect, const bool verify,
+                     const uint32_t frame_capacity)
+    : device_(allocator.device()), allocator_(&allocator),
+      draw_indirect_count_(draw_indirect_count),
+      multi_draw_indirect_(multi_draw_indirect), verify_(verify),
+      frame_capacity_(frame_capacity), frame_count_(frame_count),
+      frame_stride_(FreeList::align_up(
+          sizeof(Frame), allocator.physical_device()
+                             .getProperties()
+                             .limits.minUniformBufferOffsetAlignment)) {
+  const auto host = vk::MemoryPropertyFlagBits::eHostVisible |
+                    vk::MemoryPropertyFlagBits::eHostCoherent;
+  // The results only leave the GPU when they are read back for verification.
+  const auto results = verify_ ? host
+                               : vk::MemoryPropertyFlags(
+                                     vk::MemoryPropertyFlagBits::eDeviceLocal);
+  const auto instances =
+      static_cast<vk::DeviceSize>(frame_capacity_) * frame_count_;
+
+  std::tie(frame_buffer_, frame_allocation_) = allocator.create_buffer(
+      frame_stride_ * frame_count_, vk::BufferUsageFlagBits::eUniformBuffer,
+      host, MemoryCategory::Uniforms);
+  std::tie(object_buffer_, object_allocation_) = allocator.create_buffer(
+      sizeof(Object) * instances, vk::BufferUsageFlagBits::eStorageBuffer, host,
+      MemoryCategory::Uniforms);
+  std::tie(indirect_buffer_, indirect_allocation_) = allocator.create_buffer(
+      sizeof(Command) * instances,
+      vk::BufferUsageFlagBits::eStorageBuffer |
+          vk::BufferUsageFlagBits::eIndirectBuffer,
+      results);
+  std::tie(count_buffer_, count_allocation_) = allocator.create_buffer(
+      sizeof(uint32_t) * frame_count_,
+      vk::BufferUsageFlagBits::eStorageBuffer |
+          vk::BufferUsageFlagBits::eIndirectBuffer |
+          vk::BufferUsageFlagBits::eTransferDst,
+      results);
+  std::tie(model_buffer_, model_allocation_) = allocator.create_buffer(
+      sizeof(glm::mat4) * instances, vk::BufferUsageFlagBits::eStorageBuffer,
+      vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  create_pipeline(pipeline_cache, cull_shader);
+  create_descriptor_sets();
+}
+
+void GpuCuller::create_pipeline(PipelineCache &pipeline_cache,
+                                const vk::ShaderModule cull_shader) {
+  const auto storage = [](const uint32_t binding) {
+    return vk::DescriptorSetLayoutBinding(
+        binding, vk::DescriptorType::eStorageBuffer, 1,
+        vk::ShaderStageFlagBits::eCompute);
+  };
+
+  const vk::DescriptorSetLayoutBinding bindings[] = {
+      {0, vk::DescriptorType::eUniformBuffer, 1,
+       vk::ShaderStageFlagBits::eCompute},
+      storage(1),
+      storage(2),
+      storage(3),
+      storage(4)};
+
+  set_layout_ = device_.createDescriptorSetLayout(
+      vk::DescriptorSetLayoutCreateInfo().setBindings(bindings));
+  pipeline_layout_ = device_.createPipelineLayout(
+      vk::PipelineLayoutCreateInfo().setSetLayouts(set_layout_));
+
+  const vk::Bool32 compact = draw_indirect_count_;
+  const vk::SpecializationMapEntry specialization_entry{0, 0,
+                                                        sizeof(vk::Bool32)};
+
+  vk::SpecializationInfo specialization_info{};
+  specialization_info.setMapEntries(specialization_entry)
+      .setDataSize(sizeof compact)
+      .setPData(&compact);
+
+  const auto result = pipeline_cache.create_compute_pipeline(
+      vk::ComputePipelineCreateInfo()
+          .setStage(vk::PipelineShaderStageCreateInfo()
+                        .setStage(vk::ShaderStageFlagBits::eCompute)
+                        .setModule(cull_shader)
+                        .setPName("main")
+                        .setPSpecializationInfo(&specialization_info))
+          .setLayout(pipeline_layout_));
+
+  if (result.result != vk::Result::eSuccess)
+    throw std::runtime_error("Failed to create the culling pipeline!");
+
+  pipeline_ = result.value;
+}
+
+void GpuCuller::create_descriptor_sets() {
+  const vk::DescriptorPoolSize pool_sizes[] = {
+      {vk::DescriptorType::eUniformBuffer, frame_count_},
+      {vk::DescriptorType::eStorageBuffer, 4 * frame_count_}};
+
+  descriptor_pool_ =
+      device_.createDescriptorPool(vk::DescriptorPoolCreateInfo()
+                                       .setMaxSets(frame_count_)
+                                       .setPoolSizes(pool_sizes));
+
+  const std::vector layouts(frame_count_, set_layout_);
+  descriptor_sets_ =
+      device_.allocateDescriptorSets(vk::DescriptorSetAllocateInfo()
+                                         .setDescriptorPool(descriptor_pool_)
+                                         .setSetLayouts(layouts));
+
+  // Only the frame parameters differ per slot; the storage buffers are bound
+  // whole and indexed from frame.firstInstance.
+  for (uint32_t slot = 0; slot < frame_count_; slot++) {
+    const vk::DescriptorBufferInfo frame_info{
+        frame_buffer_, frame_stride_ * slot, sizeof(Frame)};
+    const vk::DescriptorBufferInfo storage_infos[] = {
+        {object_buffer_, 0, VK_WHOLE_SIZE},
+        {indirect_buffer_, 0, VK_WHOLE_SIZE},
+        {count_buffer_, 0, VK_WHOLE_SIZE},
+        {model_buffer_, 0, VK_WHOLE_SIZE}};
+
+    std::vector<vk::WriteDescriptorSet> writes;
+    writes.push_back(vk::WriteDescriptorSet()
+                         .setDstSet(descriptor_sets_[slot])
+                         .setDstBinding(0)
+                         .setDescriptorType(vk::DescriptorType::eUniformBuffer)
+                         .setBufferInfo(frame_info));
+
+    for (uint32_t i = 0; i < 4; i++)
+      writes.push_back(
+          vk::WriteDescriptorSet()
+              .setDstSet(descriptor_sets_[slot])
+              .setDstBinding(i + 1)
+              .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+              .setBufferInfo(storage_infos[i]));
+
+    device_.updateDescriptorSets(writes, nullptr);
+  }
+}
+
+void GpuCuller::begin_frame(const uint32_t frame,
+                            const glm::mat4 *view_projections,
+                            const glm::vec3 *view_positions,
+                            const uint32_t view_count) {
+  slot_ = frame % frame_count_;
+
+  frame_ = {};
+  frame_.view_count = std::min(view_count, max_views);
+  frame_.first_instance = slot_ * frame_capacity_;
+  frame_.slot = slot_;
+
+  for (uint32_t view = 0; view < frame_.view_count; view++) {
+    const auto frustum = Frustum::from_matrix(view_projections[view]);
+    std::ranges::copy(frustum.planes, frame_.planes + view * 6);
+    frame_.positions[view] = glm::vec4(view_positions[view], 1.f);
+  }
+
+  objects_.clear();
+}
+
+void GpuCuller::add(const Mesh &mesh, const glm::mat4 &model) {
+  const auto meshlets = mesh.meshlets();
+
+  if (objects_.size() + std::max<size_t>(meshlets.size(), 1) >
+      frame_capacity_)
+    throw std::runtime_error("Culling frame capacity exceeded!");
+
+  const auto [index_count, first_index, vertex_offset, index_type] =
+      mesh.draw_parameters();
+
+  // The indirect draws all use the pool's eUint32 binding.
+  if (index_type != vk::IndexType::eUint32)
+    throw std::runtime_error("GPU culled meshes need 32-bit indices!");
+
+  const auto &decode = mesh.decode_matrix();
+  const glm::vec4 decode_scale(decode[0][0], decode[1][1], decode[2][2], 1.f);
+
+  if (meshlets.empty()) {
+    const auto bounds = mesh.bounding_sphere();
+
+    objects_.push_back({model, glm::vec4(bounds.center, bounds.radius),
+                        glm::vec4(0.f, 0.f, 1.f, 1.f), decode_scale,
+                        decode[3], index_count, first_index, vertex_offset,
+                        0});
+    return;
+  }
+
+  // Cone axes are normals, so they take the inverse transpose. The cutoff
+  // only survives rotation and uniform scale; other transforms widen some
+  // of the normals' angles, so their cones are turned off.
+  const auto linear = glm::mat3(model);
+  const auto normal_matrix = glm::transpose(glm::inverse(linear));
+
+  const auto scale = glm::vec3(glm::length(linear[0]), glm::length(linear[1]),
+                               glm::length(linear[2]));
+  const auto uniform =
+      glm::all(glm::lessThanEqual(glm::abs(scale - scale.x),
+                                  glm::vec3(scale.x * 1e-4f)));
+
+  for (const auto &meshlet : meshlets)
+    objects_.push_back(
+        {model, glm::vec4(meshlet.sphere.center, meshlet.sphere.radius),
+         glm::vec4(glm::normalize(normal_matrix * meshlet.cone_axis),
+                   uniform ? meshlet.cone_cutoff : 1.f),
+         decode_scale, decode[3], meshlet.index_count,
+         first_index + meshlet.first_index, vertex_offset, 0});
+}
+
+void GpuCuller::dispatch(const vk::CommandBuffer commands) {
+  frame_.object_count = static_cast<uint32_t>(objects_.size());
+
+  std::memcpy(static_cast<std::byte *>(frame_allocation_.mapped) +
+                  frame_stride_ * slot_,
+              &frame_, sizeof(Frame));
+  std::memcpy(static_cast<Object *>(object_allocation_.mapped) +
+                  frame_.first_instance,
+              objects_.data(), sizeof(Object) * objects_.size());
+
+  commands.fillBuffer(count_buffer_, sizeof(uint32_t) * slot_,
+                      sizeof(uint32_t), 0);
+
+  commands.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eComputeShader, {},
+      vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                        vk::AccessFlagBits::eShaderRead |
+                            vk::AccessFlagBits::eShaderWrite),
+      nullptr, nullptr);
+
+  if (frame_.object_count > 0) {
+    commands.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline_);
+    commands.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                pipeline_layout_, 0, descriptor_sets_[slot_],
+                                nullptr);
+    commands.dispatch((frame_.object_count + 63) / 64, 1, 1);
+  }
+
+  auto dst_stages = vk::PipelineStageFlagBits::eDrawIndirect |
+                    vk::PipelineStageFlagBits::eVertexShader;
+  auto dst_access = vk::AccessFlagBits::eIndirectCommandRead |
+                    vk::AccessFlagBits::eShaderRead;
+
+  if (verify_) {
+    dst_stages |= vk::PipelineStageFlagBits::eHost;
+    dst_access |= vk::AccessFlagBits::eHostRead;
+  }
+
+  commands.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer |
+          vk::PipelineStageFlagBits::eComputeShader,
+      dst_stages, {},
+      vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite |
+                            vk::AccessFlagBits::eShaderWrite,
+                        dst_access),
+      nullptr, nullptr);
+
+  stats_.objects += frame_.object_count;
+  stats_.dispatches++;
+}
+
+void GpuCuller::draw(const vk::CommandBuffer command_buffer) const {
+  const auto count = static_cast<uint32_t>(objects_.size());
+  if (count == 0)
+    return;
+
+  const vk::DeviceSize offset = sizeof(Command) * frame_.first_instance;
+
+  if (draw_indirect_count_) {
+    command_buffer.drawIndexedIndirectCount(
+        indirect_buffer_, offset, count_buffer_, sizeof(uint32_t) * slot_,
+        count, sizeof(Command));
+  } else if (multi_draw_indirect_) {
+    command_buffer.drawIndexedIndirect(indirect_buffer_, offset, count,
+                                       sizeof(Command));
+  } else {
+    // Without multiDrawIndirect every command needs its own call.
+    for (uint32_t i = 0; i < count; i++)
+      command_buffer.drawIndexedIndirect(
+          indirect_buffer_, offset + sizeof(Command) * i, 1, sizeof(Command));
+  }
+}
+
+auto GpuCuller::verify() -> bool {
+  if (!verify_)
+    return true;
+
+  std::vector<Frustum> frusta(frame_.view_count);
+  for (uint32_t view = 0; view < frame_.view_count; view++)
+    std::copy_n(frame_.planes + view * 6, 6, frusta[view].planes.begin());
+
+  std::vector<uint32_t> expected;
+
+  for (uint32_t i = 0; i < objects_.size(); i++) {
+    const auto &object = objects_[i];
+    const auto sphere =
+        BoundingSphere{glm::vec3(object.sphere), object.sphere.w}.transformed(
+            object.model);
+    const auto axis = glm::vec3(object.cone);
+
+    for (uint32_t view = 0; view < frame_.view_count; view++) {
+      const auto offset = sphere.center - glm::vec3(frame_.positions[view]);
+      const auto back_facing =
+          object.cone.w < 1.f &&
+          glm::dot(offset, axis) >=
+              object.cone.w * glm::length(offset) + sphere.radius;
+
+      if (!back_facing && frusta[view].intersects(sphere)) {
+        expected.push_back(i);
+        break;
+      }
+    }
+  }
+
+  const auto matches = kept_objects() == expected;
+
+  stats_.verified_frames++;
+  if (!matches)
+    stats_.mismatched_frames++;
+
+  return matches;
+}
+
+auto GpuCuller::kept_objects() const -> std::vector<uint32_t> {
+  if (!verify_)
+    throw std::runtime_error("Culling results are not host visible!");
+
+  const auto commands = static_cast<const Command *>(
+                            indirect_allocation_.mapped) +
+                        frame_.first_instance;
+
+  std::vector<uint32_t> kept;
+
+  if (draw_indirect_count_) {
+    const auto count =
+        static_cast<const uint32_t *>(count_allocation_.mapped)[slot_];
+
+    for (uint32_t i = 0; i < count; i++)
+      kept.push_back(commands[i].object);
+  } else {
+    for (uint32_t i = 0; i < objects_.size(); i++)
+      if (commands[i].draw.instanceCount > 0)
+        kept.push_back(commands[i].object);
+  }
+
+  std::ranges::sort(kept);
+  return kept;
+}
+
+void GpuCuller::destroy() {
+  device_.destroyPipeline(pipeline_);
+  device_.destroyPipelineLayout(pipeline_layout_);
+  device_.destroyDescriptorPool(descriptor_pool_);
+  device_.destroyDescriptorSetLayout(set_layout_);
+
+  allocator_->destroy_buffer(frame_buffer_, frame_allocation_);
+  allocator_->destroy_buffer(object_buffer_, object_allocation_);
+  allocator_->destroy_buffer(indirect_buffer_, indirect_allocation_);
+  allocator_->destroy_buffer(count_buffer_, count_allocation_);
+  allocator_->destroy_buffer(model_buffer_, model_allocation_);
+}
+
+} // namespace mov
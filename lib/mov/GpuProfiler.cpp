@@ -0,0 +1,183 @@
+#include <mov/GpuProfiler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace mov {
+
+GpuProfiler::GpuProfiler(const vk::Instance instance, const vk::Device device,
+                         const uint32_t frame_count,
+                         const float timestamp_period,
+                         const uint32_t query_capacity, const uint32_t window)
+    : device_(device), timestamp_period_(timestamp_period),
+      query_capacity_(query_capacity), window_(window), used_(frame_count, 0),
+      pending_(frame_count) {
+  if (timing())
+    query_pool_ = device_.createQueryPool(
+        vk::QueryPoolCreateInfo()
+            .setQueryType(vk::QueryType::eTimestamp)
+            .setQueryCount(query_capacity_ * frame_count));
+
+  if (instance) {
+    begin_label_ = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(
+        instance.getProcAddr("vkCmdBeginDebugUtilsLabelEXT"));
+    end_label_ = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(
+        instance.getProcAddr("vkCmdEndDebugUtilsLabelEXT"));
+  }
+}
+
+void GpuProfiler::begin_frame(const uint32_t slot,
+                              const vk::CommandBuffer commands) {
+  std::scoped_lock lock(mutex_);
+
+  slot_ = slot;
+  collect(slot_);
+
+  if (timing())
+    commands.resetQueryPool(query_pool_, slot_ * query_capacity_,
+                            query_capacity_);
+}
+
+void GpuProfiler::collect(const uint32_t slot) {
+  auto &pending = pending_[slot];
+
+  if (pending.empty() || !timing()) {
+    pending.clear();
+    used_[slot] = 0;
+    return;
+  }
+
+  // A value and an availability word per query; scopes that were never
+  // ended or never executed stay unavailable and are skipped.
+  std::vector<uint64_t> results(used_[slot] * 2);
+  const auto result = device_.getQueryPoolResults(
+      query_pool_, slot * query_capacity_, used_[slot],
+      results.size() * sizeof(uint64_t), results.data(),
+      2 * sizeof(uint64_t),
+      vk::QueryResultFlagBits::e64 |
+          vk::QueryResultFlagBits::eWithAvailability);
+
+  std::vector<double> frame_ms(names_.size(), -1.);
+
+  if (result == vk::Result::eSuccess || result == vk::Result::eNotReady) {
+    for (const auto &[name, begin, end] : pending) {
+      if (results[begin * 2 + 1] == 0 || results[end * 2 + 1] == 0)
+        continue;
+
+      const auto ticks = results[end * 2] - results[begin * 2];
+      const auto ms = static_cast<double>(ticks) * timestamp_period_ * 1e-6;
+
+      frame_ms[name] = std::max(frame_ms[name], 0.) + ms;
+    }
+  }
+
+  for (uint32_t name = 0; name < frame_ms.size(); name++) {
+    if (frame_ms[name] < 0.)
+      continue;
+
+    auto &samples = samples_[name];
+    samples.push_back(frame_ms[name]);
+    while (samples.size() > window_)
+      samples.pop_front();
+  }
+
+  pending.clear();
+  used_[slot] = 0;
+}
+
+auto GpuProfiler::begin(const vk::CommandBuffer commands,
+                        const std::string_view name,
+                        const uint32_t view_count) -> Scope {
+  Scope scope{};
+  scope.view_count = view_count;
+
+  const std::string label(name);
+
+  {
+    std::scoped_lock lock(mutex_);
+
+    const auto [entry, inserted] = name_ids_.try_emplace(
+        label, static_cast<uint32_t>(names_.size()));
+    if (inserted) {
+      names_.push_back(label);
+      samples_.emplace_back();
+    }
+    scope.name = entry->second;
+
+    // Both timestamps are reserved up front so end() needs no lock.
+    auto &used = used_[slot_];
+    if (timing() && used + view_count * 2 <= query_capacity_) {
+      scope.query = slot_ * query_capacity_ + used;
+      pending_[slot_].push_back({scope.name, used, used + view_count});
+      used += view_count * 2;
+    }
+  }
+
+  if (begin_label_) {
+    const VkDebugUtilsLabelEXT info{VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                                    nullptr, label.c_str(), {}};
+    begin_label_(commands, &info);
+  }
+
+  if (scope.query != ~0u)
+    commands.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe,
+                            query_pool_, scope.query);
+
+  return scope;
+}
+
+void GpuProfiler::end(const vk::CommandBuffer commands, const Scope &scope) {
+  if (scope.query != ~0u)
+    commands.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe,
+                            query_pool_, scope.query + scope.view_count);
+
+  if (end_label_)
+    end_label_(commands);
+}
+
+auto GpuProfiler::stats(const std::string_view name) const
+    -> GpuTimingStats {
+  std::scoped_lock lock(mutex_);
+
+  const auto entry = name_ids_.find(std::string(name));
+  if (entry == name_ids_.end())
+    return {};
+
+  const auto &samples = samples_[entry->second];
+  if (samples.empty())
+    return {};
+
+  std::vector sorted(samples.begin(), samples.end());
+  std::ranges::sort(sorted);
+
+  const auto p99 = static_cast<size_t>(
+      std::ceil(0.99 * static_cast<double>(sorted.size()))) - 1;
+
+  return {sorted.size(), sorted.front(),
+          std::accumulate(sorted.begin(), sorted.end(), 0.) /
+              static_cast<double>(sorted.size()),
+          sorted[p99], samples.back()};
+}
+
+auto GpuProfiler::report() const
+    -> std::vector<std::pair<std::string, GpuTimingStats>> {
+  std::vector<std::string> names;
+  {
+    std::scoped_lock lock(mutex_);
+    names = names_;
+  }
+
+  std::vector<std::pair<std::string, GpuTimingStats>> report;
+  for (const auto &name : names)
+    report.emplace_back(name, stats(name));
+
+  return report;
+}
+
+void GpuProfiler::destroy() {
+  if (query_pool_)
+    device_.destroyQueryPool(query_pool_);
+}
+
+} // namespace mov
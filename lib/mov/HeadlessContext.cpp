@@ -0,0 +1,132 @@
+#include <mov/HeadlessContext.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace mov {
+
+namespace {
+
+auto find_queue_family(const vk::PhysicalDevice physical_device) {
+  const auto families = physical_device.getQueueFamilyProperties();
+  const auto required =
+      vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute;
+
+  for (uint32_t i = 0; i < families.size(); i++)
+    if (families[i].queueCount > 0 &&
+        (families[i].queueFlags & required) == required)
+      return i;
+
+  return ~0u;
+}
+
+} // namespace
+
+HeadlessContext::HeadlessContext() {
+  const auto api_version =
+      std::min(vk::enumerateInstanceVersion(), VK_API_VERSION_1_2);
+
+  const vk::ApplicationInfo application_info{"mov headless", 1, "mov", 1,
+                                             api_version};
+  instance_ = vk::createInstance(
+      vk::InstanceCreateInfo().setPApplicationInfo(&application_info));
+
+  const auto *const wanted = std::getenv("MOV_DEVICE");
+
+  for (const auto candidate : instance_.enumeratePhysicalDevices()) {
+    const std::string name = candidate.getProperties().deviceName;
+
+    if (find_queue_family(candidate) == ~0u ||
+        (wanted && name.find(wanted) == std::string::npos))
+      continue;
+
+    physical_device_ = candidate;
+    break;
+  }
+
+  if (!physical_device_) {
+    instance_.destroy();
+    throw std::runtime_error("Failed to find a headless Vulkan device!");
+  }
+
+  queue_family_ = find_queue_family(physical_device_);
+
+  const auto properties = physical_device_.getProperties();
+  if (physical_device_.getQueueFamilyProperties()[queue_family_]
+          .timestampValidBits > 0)
+    timestamp_period_ = properties.limits.timestampPeriod;
+
+  const auto supported = physical_device_.getFeatures();
+  features_.multi_draw_indirect = supported.multiDrawIndirect;
+
+  if (api_version >= VK_API_VERSION_1_2 &&
+      properties.apiVersion >= VK_API_VERSION_1_2)
+    features_.draw_indirect_count =
+        physical_device_
+            .getFeatures2<vk::PhysicalDeviceFeatures2,
+                          vk::PhysicalDeviceVulkan12Features>()
+            .get<vk::PhysicalDeviceVulkan12Features>()
+            .drawIndirectCount == VK_TRUE;
+
+  const float priority = 1.f;
+  const vk::DeviceQueueCreateInfo queue_info{{}, queue_family_, 1, &priority};
+
+  vk::PhysicalDeviceFeatures enabled_features{};
+  // VkImage gives every image an anisotropic sampler.
+  enabled_features.setMultiDrawIndirect(features_.multi_draw_indirect)
+      .setSamplerAnisotropy(supported.samplerAnisotropy);
+
+  vk::PhysicalDeviceVulkan12Features vulkan12_features{};
+  vulkan12_features.setDrawIndirectCount(features_.draw_indirect_count);
+
+  device_ = physical_device_.createDevice(
+      vk::DeviceCreateInfo()
+          .setQueueCreateInfos(queue_info)
+          .setPEnabledFeatures(&enabled_features)
+          .setPNext(features_.draw_indirect_count ? &vulkan12_features
+                                                  : nullptr));
+  queue_ = device_.getQueue(queue_family_, 0);
+
+  command_pool_ = device_.createCommandPool(
+      {vk::CommandPoolCreateFlagBits::eTransient, queue_family_});
+}
+
+auto HeadlessContext::begin_commands() const -> vk::CommandBuffer {
+  const auto commands = device_.allocateCommandBuffers(
+      vk::CommandBufferAllocateInfo()
+          .setCommandPool(command_pool_)
+          .setLevel(vk::CommandBufferLevel::ePrimary)
+          .setCommandBufferCount(1))[0];
+
+  commands.begin(vk::CommandBufferBeginInfo().setFlags(
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+  return commands;
+}
+
+void HeadlessContext::end_commands(const vk::CommandBuffer commands) const {
+  commands.end();
+
+  const auto fence = device_.createFence({});
+  queue_.submit(vk::SubmitInfo().setCommandBuffers(commands), fence);
+
+  const auto result = device_.waitForFences(
+      fence, true, std::numeric_limits<uint64_t>::max());
+
+  device_.destroyFence(fence);
+  device_.freeCommandBuffers(command_pool_, commands);
+
+  if (result != vk::Result::eSuccess)
+    throw std::runtime_error("Failed to wait for headless commands!");
+}
+
+void HeadlessContext::destroy() {
+  device_.destroyCommandPool(command_pool_);
+  device_.destroy();
+  instance_.destroy();
+}
+
+} // namespace mov
@@ -0,0 +1,86 @@
+#include <mov/InstanceBatcher.hpp>
+
+#include <cstring>
+
+namespace mov {
+
+InstanceBatcher::InstanceBatcher(VkAllocator &allocator,
+                                 const uint32_t frame_count,
+                                 const uint32_t frame_capacity)
+    : allocator_(&allocator), frame_capacity_(frame_capacity),
+      frame_count_(frame_count) {
+  std::tie(buffer_, allocation_) = allocator.create_buffer(
+      sizeof(glm::mat4) * frame_capacity_ * frame_count_,
+      vk::BufferUsageFlagBits::eStorageBuffer,
+      vk::MemoryPropertyFlagBits::eHostVisible |
+          vk::MemoryPropertyFlagBits::eHostCoherent,
+      MemoryCategory::Uniforms);
+}
+
+void InstanceBatcher::begin_frame(const uint32_t frame) {
+  frame_begin_ = (frame % frame_count_) * frame_capacity_;
+  written_ = false;
+
+  for (auto &group : groups_)
+    group.models.clear();
+}
+
+void InstanceBatcher::add(const Mesh &mesh, const glm::mat4 &model) {
+  const auto [it, inserted] = group_indices_.try_emplace(
+      mesh.handle(), static_cast<uint32_t>(groups_.size()));
+
+  if (inserted)
+    groups_.push_back({mesh, {}, 0});
+
+  groups_[it->second].models.push_back(model * mesh.decode_matrix());
+}
+
+void InstanceBatcher::write() {
+  const auto data = static_cast<glm::mat4 *>(allocation_.mapped);
+
+  auto cursor = frame_begin_;
+
+  for (auto &group : groups_) {
+    if (group.models.empty())
+      continue;
+
+    const auto count = static_cast<uint32_t>(group.models.size());
+
+    if (cursor + count > frame_begin_ + frame_capacity_)
+      throw std::runtime_error("Instance buffer frame capacity exceeded!");
+
+    std::memcpy(data + cursor, group.models.data(),
+                sizeof(glm::mat4) * count);
+
+    group.first_instance = cursor;
+    cursor += count;
+  }
+
+  written_ = true;
+}
+
+void InstanceBatcher::draw(const vk::CommandBuffer command_buffer) {
+  if (!written_)
+    write();
+
+  for (const auto &group : groups_) {
+    if (group.models.empty())
+      continue;
+
+    const auto count = static_cast<uint32_t>(group.models.size());
+
+    group.mesh.draw(command_buffer, count, group.first_instance);
+
+    stats_.instances += count;
+    stats_.draws++;
+  }
+}
+
+void InstanceBatcher::destroy() {
+  allocator_->destroy_buffer(buffer_, allocation_);
+
+  group_indices_.clear();
+  groups_.clear();
+}
+
+} // namespace mov
@@ -0,0 +1,42 @@
+#include <mov/LodChain.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace mov {
+
+LodChain::LodChain(std::vector<MeshLod> levels) : levels_(std::move(levels)) {
+  if (levels_.empty())
+    throw std::runtime_error("A LOD chain needs at least one level");
+}
+
+void LodChain::select(const LodView &view, const float distance,
+                      const float scale) {
+  const auto pixels_per_unit =
+      scale * view.projection_scale / std::max(distance, 1e-4f);
+  const auto pixels = [&](const uint32_t level) {
+    return levels_[level].error * pixels_per_unit;
+  };
+  const auto coarsest = [&](const float threshold) {
+    uint32_t level = 0;
+    while (level + 1 < levels_.size() && pixels(level + 1) <= threshold)
+      level++;
+    return level;
+  };
+
+  // Refine as soon as the current level is too coarse, but only coarsen
+  // once the next level is comfortably under the threshold.
+  if (pixels(current_) > view.max_pixel_error)
+    current_ = coarsest(view.max_pixel_error);
+  else
+    current_ = std::max(
+        current_, coarsest(view.max_pixel_error * (1.f - view.hysteresis)));
+}
+
+void LodChain::destroy() const {
+  for (const auto &level : levels_)
+    level.mesh.destroy();
+}
+
+} // namespace mov
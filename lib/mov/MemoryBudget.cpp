@@ -0,0 +1,67 @@
+#include <mov/MemoryBudget.hpp>
+
+#include <algorithm>
+
+namespace mov {
+
+MemoryBudget::MemoryBudget(const VkAllocator &allocator,
+                           const bool memory_budget_enabled)
+    : allocator_(&allocator), memory_budget_enabled_(memory_budget_enabled) {
+  const auto &properties = allocator.memory_properties();
+
+  report_.heaps.resize(properties.memoryHeapCount);
+  above_threshold_.resize(properties.memoryHeapCount, false);
+
+  for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+    report_.heaps[i].device_local = static_cast<bool>(
+        properties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+}
+
+void MemoryBudget::on_threshold(const float share, Callback callback) {
+  threshold_ = share;
+  callback_ = std::move(callback);
+}
+
+auto MemoryBudget::update() -> const MemoryReport & {
+  const auto &properties = allocator_->memory_properties();
+
+  report_.from_driver = memory_budget_enabled_;
+
+  if (memory_budget_enabled_) {
+    const auto chain =
+        allocator_->physical_device()
+            .getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2,
+                                  vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    const auto &budget =
+        chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+    for (uint32_t i = 0; i < report_.heaps.size(); i++) {
+      report_.heaps[i].usage = budget.heapUsage[i];
+      report_.heaps[i].budget = budget.heapBudget[i];
+    }
+  } else {
+    for (uint32_t i = 0; i < report_.heaps.size(); i++) {
+      report_.heaps[i].usage = allocator_->heap_usage(i);
+      report_.heaps[i].budget = properties.memoryHeaps[i].size;
+    }
+  }
+
+  report_.categories = allocator_->category_usage();
+  report_.category_high_water = allocator_->category_peak();
+
+  for (uint32_t i = 0; i < report_.heaps.size(); i++) {
+    auto &heap = report_.heaps[i];
+    heap.high_water = std::max(heap.high_water, heap.usage);
+
+    const auto above = heap.share() > threshold_;
+
+    if (above && !above_threshold_[i] && callback_)
+      callback_(i, heap);
+
+    above_threshold_[i] = above;
+  }
+
+  return report_;
+}
+
+} // namespace mov
@@ -0,0 +1,43 @@
+#include <mov/Mesh.hpp>
+#include <mov/MeshOptimizer.hpp>
+
+#include <optional>
+#include <utility>
+
+namespace mov {
+
+Mesh::Mesh(GeometryPool &pool, const std::vector<VertexAttributes> &vertices,
+           const std::vector<uint32_t> &indices, const VertexFormat format,
+           std::vector<Meshlet> meshlets, const bool compact_indices)
+    : pool_(&pool), box_(compute_bounding_box(vertices)),
+      sphere_(compute_bounding_sphere(vertices)), format_(format) {
+  if (!meshlets.empty())
+    meshlets_ = std::make_shared<const std::vector<Meshlet>>(
+        std::move(meshlets));
+
+  const auto short_indices = compact_indices
+                                 ? to_16bit_indices(indices)
+                                 : std::optional<std::vector<uint16_t>>();
+
+  const auto allocate = [&](const auto &pool_vertices) {
+    return short_indices ? pool.allocate(pool_vertices, *short_indices)
+                         : pool.allocate(pool_vertices, indices);
+  };
+
+  if (format_ == VertexFormat::Packed) {
+    const auto packed = pack_vertices(vertices);
+
+    handle_ = allocate(packed.vertices);
+    decode_ = packed.decode;
+    return;
+  }
+
+  std::vector<Vertex> float_vertices;
+  float_vertices.reserve(vertices.size());
+  for (const auto &vertex : vertices)
+    float_vertices.push_back({vertex.position, vertex.color});
+
+  handle_ = allocate(float_vertices);
+}
+
+} // namespace mov
@@ -0,0 +1,308 @@
+#include <mov/MeshOptimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace mov {
+
+namespace {
+
+constexpr uint32_t no_entry = std::numeric_limits<uint32_t>::max();
+
+// The scoring cache is an LRU larger than the hardware one; the constants
+// are the ones the paper settles on.
+constexpr uint32_t scoring_cache_size = 32;
+constexpr float cache_decay_power = 1.5f;
+constexpr float last_triangle_score = 0.75f;
+constexpr float valence_boost_scale = 2.f;
+constexpr float valence_boost_power = 0.5f;
+
+auto vertex_score(const uint32_t cache_position, const uint32_t valence) {
+  // No triangles left to draw; never worth picking.
+  if (valence == 0)
+    return -1.f;
+
+  float score = 0.f;
+
+  if (cache_position < 3) {
+    // The last triangle's vertices are scored the same whichever order
+    // they came in.
+    score = last_triangle_score;
+  } else if (cache_position < scoring_cache_size) {
+    const auto scale = 1.f / static_cast<float>(scoring_cache_size - 3);
+    score = std::pow(1.f - static_cast<float>(cache_position - 3) * scale,
+                     cache_decay_power);
+  }
+
+  return score + valence_boost_scale *
+                     std::pow(static_cast<float>(valence),
+                              -valence_boost_power);
+}
+
+} // namespace
+
+auto analyze_vertex_cache(const std::span<const uint32_t> indices,
+                          const uint32_t vertex_count,
+                          const uint32_t cache_size) -> VertexCacheStats {
+  VertexCacheStats stats{};
+  stats.triangles = static_cast<uint32_t>(indices.size() / 3);
+
+  // A vertex is in a FIFO cache while fewer than cache_size others have
+  // been inserted after it.
+  std::vector<uint64_t> inserted(vertex_count, 0);
+  uint64_t time = cache_size + 1;
+
+  for (const auto index : indices) {
+    if (inserted[index] == 0)
+      stats.unique_vertices++;
+
+    if (time - inserted[index] > cache_size) {
+      inserted[index] = time++;
+      stats.transformed++;
+    }
+  }
+
+  return stats;
+}
+
+auto optimize_vertex_cache(const std::span<const uint32_t> indices,
+                           const uint32_t vertex_count)
+    -> std::vector<uint32_t> {
+  const auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+
+  // Triangles around each vertex; the first `valence` of a vertex's entries
+  // are the ones not yet emitted.
+  std::vector<uint32_t> valence(vertex_count, 0);
+  for (const auto index : indices)
+    valence[index]++;
+
+  std::vector<uint32_t> first(vertex_count + 1, 0);
+  std::inclusive_scan(valence.begin(), valence.end(), first.begin() + 1);
+
+  std::vector<uint32_t> adjacency(indices.size());
+  {
+    auto cursor = first;
+    for (uint32_t i = 0; i < indices.size(); i++)
+      adjacency[cursor[indices[i]]++] = i / 3;
+  }
+
+  std::vector<uint32_t> cache_position(vertex_count, no_entry);
+  std::vector<float> score(vertex_count);
+  for (uint32_t v = 0; v < vertex_count; v++)
+    score[v] = vertex_score(no_entry, valence[v]);
+
+  std::vector<float> triangle_score(triangle_count);
+  std::vector<bool> emitted(triangle_count, false);
+  for (uint32_t t = 0; t < triangle_count; t++)
+    triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] +
+                        score[indices[t * 3 + 2]];
+
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> next_cache;
+  cache.reserve(scoring_cache_size + 3);
+  next_cache.reserve(scoring_cache_size + 3);
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+
+  uint32_t best = triangle_count > 0 ? 0 : no_entry;
+  uint32_t fallback = 0;
+
+  while (best != no_entry) {
+    emitted[best] = true;
+
+    const uint32_t *corners = &indices[best * 3];
+    result.insert(result.end(), corners, corners + 3);
+
+    // Put the triangle's vertices at the front of the cache, and retire the
+    // triangle from their adjacency.
+    next_cache.assign(corners, corners + 3);
+
+    for (uint32_t i = 0; i < 3; i++) {
+      const auto v = corners[i];
+      const auto begin = adjacency.begin() + first[v];
+      const auto end = begin + valence[v];
+
+      std::iter_swap(std::find(begin, end, best), end - 1);
+      valence[v]--;
+    }
+
+    for (const auto v : cache)
+      if (v != corners[0] && v != corners[1] && v != corners[2])
+        next_cache.push_back(v);
+
+    for (uint32_t i = 0; i < next_cache.size(); i++) {
+      const auto v = next_cache[i];
+      cache_position[v] = i < scoring_cache_size ? i : no_entry;
+      score[v] = vertex_score(cache_position[v], valence[v]);
+    }
+
+    // Pick the best triangle touching the cache, rescoring as we go.
+    best = no_entry;
+    float best_score = -1.f;
+
+    for (const auto v : next_cache) {
+      for (uint32_t i = first[v]; i < first[v] + valence[v]; i++) {
+        const auto t = adjacency[i];
+        triangle_score[t] = score[indices[t * 3]] +
+                            score[indices[t * 3 + 1]] +
+                            score[indices[t * 3 + 2]];
+
+        if (triangle_score[t] > best_score) {
+          best_score = triangle_score[t];
+          best = t;
+        }
+      }
+    }
+
+    if (next_cache.size() > scoring_cache_size)
+      next_cache.resize(scoring_cache_size);
+    std::swap(cache, next_cache);
+
+    // Dead end: carry on with the next triangle in input order.
+    if (best == no_entry) {
+      while (fallback < triangle_count && emitted[fallback])
+        fallback++;
+      if (fallback < triangle_count)
+        best = fallback;
+    }
+  }
+
+  return result;
+}
+
+auto optimize_overdraw(const std::span<const uint32_t> indices,
+                       const std::vector<VertexAttributes> &vertices,
+                       const uint32_t cache_size) -> std::vector<uint32_t> {
+  const auto triangle_count = static_cast<uint32_t>(indices.size() / 3);
+
+  // Clusters start where a triangle misses the cache on all three corners,
+  // so reordering them does not break up runs of shared vertices.
+  std::vector<uint32_t> cluster_starts;
+  {
+    std::vector<uint64_t> inserted(vertices.size(), 0);
+    uint64_t time = cache_size + 1;
+
+    for (uint32_t t = 0; t < triangle_count; t++) {
+      uint32_t misses = 0;
+
+      for (uint32_t i = 0; i < 3; i++) {
+        const auto index = indices[t * 3 + i];
+        if (time - inserted[index] > cache_size) {
+          inserted[index] = time++;
+          misses++;
+        }
+      }
+
+      if (t == 0 || misses == 3)
+        cluster_starts.push_back(t);
+    }
+  }
+  cluster_starts.push_back(triangle_count);
+
+  const auto cluster_count = static_cast<uint32_t>(cluster_starts.size() - 1);
+
+  struct Cluster {
+    glm::vec3 centroid{0.f};
+    glm::vec3 normal{0.f};
+    float area{0.f};
+  };
+
+  std::vector<Cluster> clusters(cluster_count);
+  glm::vec3 mesh_centroid(0.f);
+  float mesh_area = 0.f;
+
+  for (uint32_t i = 0; i < cluster_count; i++) {
+    auto &cluster = clusters[i];
+
+    for (auto t = cluster_starts[i]; t < cluster_starts[i + 1]; t++) {
+      const auto &a = vertices[indices[t * 3]].position;
+      const auto &b = vertices[indices[t * 3 + 1]].position;
+      const auto &c = vertices[indices[t * 3 + 2]].position;
+
+      // Twice the area, in the direction of the face normal.
+      const auto normal = glm::cross(b - a, c - a);
+      const auto area = glm::length(normal);
+
+      cluster.centroid += (a + b + c) / 3.f * area;
+      cluster.normal += normal;
+      cluster.area += area;
+    }
+
+    mesh_centroid += cluster.centroid;
+    mesh_area += cluster.area;
+
+    if (cluster.area > 0.f)
+      cluster.centroid /= cluster.area;
+  }
+
+  if (mesh_area > 0.f)
+    mesh_centroid /= mesh_area;
+
+  // Clusters facing away from the middle of the mesh are on its outside and
+  // the most likely to hide others.
+  std::vector<float> outwardness(cluster_count, 0.f);
+  for (uint32_t c = 0; c < cluster_count; c++) {
+    const auto length = glm::length(clusters[c].normal);
+    if (length > 0.f)
+      outwardness[c] = glm::dot(clusters[c].centroid - mesh_centroid,
+                                clusters[c].normal / length);
+  }
+
+  std::vector<uint32_t> order(cluster_count);
+  std::iota(order.begin(), order.end(), 0u);
+  std::ranges::stable_sort(order, std::greater{},
+                           [&](const uint32_t c) { return outwardness[c]; });
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+
+  for (const auto c : order)
+    result.insert(result.end(), indices.begin() + cluster_starts[c] * 3,
+                  indices.begin() + cluster_starts[c + 1] * 3);
+
+  return result;
+}
+
+void optimize_vertex_fetch(std::vector<uint32_t> &indices,
+                           std::vector<VertexAttributes> &vertices) {
+  std::vector<uint32_t> remap(vertices.size(), no_entry);
+  std::vector<VertexAttributes> reordered;
+  reordered.reserve(vertices.size());
+
+  for (auto &index : indices) {
+    if (remap[index] == no_entry) {
+      remap[index] = static_cast<uint32_t>(reordered.size());
+      reordered.push_back(vertices[index]);
+    }
+
+    index = remap[index];
+  }
+
+  vertices = std::move(reordered);
+}
+
+void optimize_mesh(std::vector<uint32_t> &indices,
+                   std::vector<VertexAttributes> &vertices) {
+  const auto vertex_count = static_cast<uint32_t>(vertices.size());
+
+  indices = optimize_overdraw(optimize_vertex_cache(indices, vertex_count),
+                              vertices);
+  optimize_vertex_fetch(indices, vertices);
+}
+
+auto to_16bit_indices(const std::span<const uint32_t> indices)
+    -> std::optional<std::vector<uint16_t>> {
+  if (std::ranges::any_of(indices, [](const uint32_t index) {
+        return index > std::numeric_limits<uint16_t>::max();
+      }))
+    return std::nullopt;
+
+  return std::vector<uint16_t>(indices.begin(), indices.end());
+}
+
+} // namespace mov
@@ -0,0 +1,327 @@
+#include <mov/Bounds.hpp>
+#include <mov/MeshSimplifier.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+
+namespace mov {
+
+namespace {
+
+// Sum of squared distances to a set of planes, each weighted by the area of
+// the triangle it came from.
+struct Quadric {
+  float a00{0.f}, a11{0.f}, a22{0.f};
+  float a01{0.f}, a02{0.f}, a12{0.f};
+  float b0{0.f}, b1{0.f}, b2{0.f};
+  float c{0.f};
+  float weight{0.f};
+
+  static auto from_plane(const glm::vec3 normal, const float distance,
+                         const float weight) {
+    const auto n = normal * weight;
+
+    return Quadric{n.x * normal.x, n.y * normal.y, n.z * normal.z,
+                   n.x * normal.y, n.x * normal.z, n.y * normal.z,
+                   n.x * distance, n.y * distance, n.z * distance,
+                   distance * distance * weight, weight};
+  }
+
+  void add(const Quadric &other) {
+    a00 += other.a00;
+    a11 += other.a11;
+    a22 += other.a22;
+    a01 += other.a01;
+    a02 += other.a02;
+    a12 += other.a12;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+  }
+
+  // Mean squared distance of p to the planes.
+  [[nodiscard]] auto error(const glm::vec3 p) const {
+    const auto rx = a00 * p.x + a01 * p.y + a02 * p.z;
+    const auto ry = a01 * p.x + a11 * p.y + a12 * p.z;
+    const auto rz = a02 * p.x + a12 * p.y + a22 * p.z;
+
+    const auto squared = p.x * rx + p.y * ry + p.z * rz +
+                         2.f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+
+    return weight > 0.f ? std::abs(squared) / weight : 0.f;
+  }
+};
+
+struct Collapse {
+  uint32_t from;
+  uint32_t to;
+  float cost;
+};
+
+auto edge_key(const uint32_t a, const uint32_t b) {
+  return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+}
+
+} // namespace
+
+auto simplify_mesh(const std::span<const uint32_t> indices,
+                   const std::vector<VertexAttributes> &vertices,
+                   const uint32_t target_index_count, const float max_error)
+    -> SimplifiedMesh {
+  const auto vertex_count = static_cast<uint32_t>(vertices.size());
+
+  // Vertices split along a seam share a position; each is referred to by
+  // the lowest index with its position.
+  std::vector<uint32_t> position_id(vertex_count);
+  std::vector<bool> locked(vertex_count, false);
+  {
+    std::vector<uint32_t> order(vertex_count);
+    std::iota(order.begin(), order.end(), 0u);
+
+    const auto key = [&](const uint32_t v) {
+      const auto &p = vertices[v].position;
+      return std::tie(p.x, p.y, p.z);
+    };
+    std::ranges::sort(order, [&](const uint32_t a, const uint32_t b) {
+      return key(a) < key(b) || (key(a) == key(b) && a < b);
+    });
+
+    for (uint32_t i = 0; i < vertex_count; i++) {
+      const auto v = order[i];
+
+      if (i > 0 && key(order[i - 1]) == key(v)) {
+        position_id[v] = position_id[order[i - 1]];
+        locked[position_id[v]] = true;
+      } else {
+        position_id[v] = v;
+      }
+    }
+  }
+
+  // Edges with one triangle are on the border, and edges with more than two
+  // are not manifold; collapsing either would tear the surface.
+  {
+    std::unordered_map<uint64_t, uint32_t> edge_triangles;
+    edge_triangles.reserve(indices.size());
+
+    for (uint32_t i = 0; i < indices.size(); i++) {
+      const auto next = i % 3 == 2 ? i - 2 : i + 1;
+      edge_triangles[edge_key(position_id[indices[i]],
+                              position_id[indices[next]])]++;
+    }
+
+    for (uint32_t i = 0; i < indices.size(); i++) {
+      const auto next = i % 3 == 2 ? i - 2 : i + 1;
+      const auto a = position_id[indices[i]];
+      const auto b = position_id[indices[next]];
+
+      if (edge_triangles[edge_key(a, b)] != 2) {
+        locked[a] = true;
+        locked[b] = true;
+      }
+    }
+  }
+
+  std::vector<Quadric> quadrics(vertex_count);
+  for (uint32_t i = 0; i < indices.size(); i += 3) {
+    const auto &p0 = vertices[indices[i]].position;
+    const auto &p1 = vertices[indices[i + 1]].position;
+    const auto &p2 = vertices[indices[i + 2]].position;
+
+    const auto normal = glm::cross(p1 - p0, p2 - p0);
+    const auto length = glm::length(normal);
+    if (length == 0.f)
+      continue;
+
+    const auto unit = normal / length;
+    const auto quadric =
+        Quadric::from_plane(unit, -glm::dot(unit, p0), length * 0.5f);
+
+    for (uint32_t j = 0; j < 3; j++)
+      quadrics[position_id[indices[i + j]]].add(quadric);
+  }
+
+  const auto is_locked = [&](const uint32_t v) {
+    return locked[position_id[v]];
+  };
+  const auto cost = [&](const uint32_t from, const uint32_t to) {
+    auto combined = quadrics[position_id[from]];
+    combined.add(quadrics[position_id[to]]);
+    return combined.error(vertices[to].position);
+  };
+
+  std::vector<uint32_t> result(indices.begin(), indices.end());
+  const auto max_cost = max_error * max_error;
+  float error = 0.f;
+
+  std::vector<Collapse> collapses;
+  std::vector<uint32_t> valence(vertex_count);
+  std::vector<uint32_t> first(vertex_count + 1);
+  std::vector<uint32_t> adjacency;
+  std::vector<bool> touched(vertex_count);
+  std::vector<uint32_t> remap(vertex_count);
+  std::iota(remap.begin(), remap.end(), 0u);
+
+  while (result.size() > target_index_count) {
+    // Every edge once, in whichever direction is cheaper to collapse.
+    collapses.clear();
+    for (uint32_t i = 0; i < result.size(); i++) {
+      const auto a = result[i];
+      const auto b = result[i % 3 == 2 ? i - 2 : i + 1];
+
+      if (position_id[a] >= position_id[b])
+        continue;
+
+      Collapse best{0, 0, std::numeric_limits<float>::max()};
+      if (!is_locked(a))
+        best = {a, b, cost(a, b)};
+      if (!is_locked(b)) {
+        const auto reverse = cost(b, a);
+        if (reverse < best.cost)
+          best = {b, a, reverse};
+      }
+
+      if (best.cost <= max_cost)
+        collapses.push_back(best);
+    }
+
+    if (collapses.empty())
+      break;
+
+    std::ranges::sort(collapses, {}, &Collapse::cost);
+
+    std::ranges::fill(valence, 0u);
+    for (const auto v : result)
+      valence[v]++;
+    std::inclusive_scan(valence.begin(), valence.end(), first.begin() + 1);
+
+    adjacency.resize(result.size());
+    {
+      auto cursor = first;
+      for (uint32_t i = 0; i < result.size(); i++)
+        adjacency[cursor[result[i]]++] = i / 3;
+    }
+
+    // A vertex is only moved once per pass, and not after its neighbourhood
+    // has changed, so the flip test below sees the current surface.
+    std::fill(touched.begin(), touched.end(), false);
+
+    auto triangles = static_cast<uint32_t>(result.size() / 3);
+    const auto target_triangles = target_index_count / 3;
+    bool collapsed = false;
+
+    for (const auto &[from, to, collapse_cost] : collapses) {
+      if (triangles <= target_triangles)
+        break;
+      if (touched[from] || touched[to])
+        continue;
+
+      const auto &target = vertices[to].position;
+      uint32_t removed = 0;
+      bool flips = false;
+
+      for (auto i = first[from]; i < first[from + 1] && !flips; i++) {
+        const auto *corners = &result[adjacency[i] * 3];
+
+        if (position_id[corners[0]] == position_id[to] ||
+            position_id[corners[1]] == position_id[to] ||
+            position_id[corners[2]] == position_id[to]) {
+          removed++;
+          continue;
+        }
+
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (uint32_t j = 0; j < 3; j++) {
+          before[j] = vertices[corners[j]].position;
+          after[j] = corners[j] == from ? target : before[j];
+        }
+
+        const auto normal_before =
+            glm::cross(before[1] - before[0], before[2] - before[0]);
+        const auto normal_after =
+            glm::cross(after[1] - after[0], after[2] - after[0]);
+
+        flips = glm::dot(normal_before, normal_after) <= 0.f;
+      }
+
+      if (flips)
+        continue;
+
+      remap[from] = to;
+      quadrics[position_id[to]].add(quadrics[position_id[from]]);
+      error = std::max(error, collapse_cost);
+      triangles -= removed;
+      collapsed = true;
+
+      touched[to] = true;
+      for (auto i = first[from]; i < first[from + 1]; i++)
+        for (uint32_t j = 0; j < 3; j++)
+          touched[result[adjacency[i] * 3 + j]] = true;
+    }
+
+    if (!collapsed)
+      break;
+
+    // Apply the pass and drop the triangles that collapsed to an edge.
+    uint32_t write = 0;
+    for (uint32_t i = 0; i < result.size(); i += 3) {
+      const auto a = remap[result[i]];
+      const auto b = remap[result[i + 1]];
+      const auto c = remap[result[i + 2]];
+
+      if (position_id[a] == position_id[b] ||
+          position_id[b] == position_id[c] ||
+          position_id[c] == position_id[a])
+        continue;
+
+      result[write++] = a;
+      result[write++] = b;
+      result[write++] = c;
+    }
+    result.resize(write);
+
+    for (const auto &collapse : collapses)
+      remap[collapse.from] = collapse.from;
+  }
+
+  return {std::move(result), std::sqrt(error)};
+}
+
+auto generate_lods(const std::span<const uint32_t> indices,
+                   const std::vector<VertexAttributes> &vertices,
+                   const LodSettings &settings) -> std::vector<SimplifiedMesh> {
+  std::vector<SimplifiedMesh> lods;
+  lods.push_back({{indices.begin(), indices.end()}, 0.f});
+
+  const auto max_error =
+      settings.max_error * compute_bounding_sphere(vertices).radius;
+  auto target = static_cast<float>(indices.size());
+
+  for (uint32_t level = 1; level < settings.max_levels; level++) {
+    target *= settings.target_ratio;
+
+    auto lod = simplify_mesh(indices, vertices,
+                             static_cast<uint32_t>(target) / 3 * 3, max_error);
+
+    // A level that barely saves anything is not worth switching to.
+    const auto previous = lods.back().indices.size();
+    if (lod.indices.empty() ||
+        static_cast<float>(lod.indices.size()) >
+            static_cast<float>(previous) * 0.9f)
+      break;
+
+    lod.error = std::max(lod.error, lods.back().error);
+    lods.push_back(std::move(lod));
+  }
+
+  return lods;
+}
+
+} // namespace mov
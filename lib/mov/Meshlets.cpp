@@ -0,0 +1,126 @@
+#include <mov/Meshlets.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mov {
+
+namespace {
+
+auto finish_meshlet(const std::span<const uint32_t> indices,
+                    const std::vector<VertexAttributes> &vertices,
+                    const uint32_t first_index, const uint32_t index_count,
+                    const bool cones) {
+  Meshlet meshlet{};
+  meshlet.first_index = first_index;
+  meshlet.index_count = index_count;
+
+  const auto corners = indices.subspan(first_index, index_count);
+
+  BoundingBox box{vertices[corners[0]].position,
+                  vertices[corners[0]].position};
+  for (const auto index : corners) {
+    box.min = glm::min(box.min, vertices[index].position);
+    box.max = glm::max(box.max, vertices[index].position);
+  }
+
+  meshlet.sphere.center = box.center();
+  for (const auto index : corners)
+    meshlet.sphere.radius =
+        std::max(meshlet.sphere.radius,
+                 glm::length(vertices[index].position - box.center()));
+
+  if (!cones)
+    return meshlet;
+
+  std::vector<glm::vec3> normals;
+  normals.reserve(index_count / 3);
+
+  glm::vec3 axis(0.f);
+  for (uint32_t i = 0; i < index_count; i += 3) {
+    const auto &p0 = vertices[corners[i]].position;
+    const auto &p1 = vertices[corners[i + 1]].position;
+    const auto &p2 = vertices[corners[i + 2]].position;
+
+    const auto normal = glm::cross(p1 - p0, p2 - p0);
+    const auto length = glm::length(normal);
+
+    // Degenerate triangles are never rasterised, whichever way they face.
+    if (length == 0.f)
+      continue;
+
+    normals.push_back(normal / length);
+    axis += normals.back();
+  }
+
+  const auto axis_length = glm::length(axis);
+  if (normals.empty() || axis_length == 0.f)
+    return meshlet;
+
+  axis /= axis_length;
+
+  auto min_dot = 1.f;
+  for (const auto &normal : normals)
+    min_dot = std::min(min_dot, glm::dot(normal, axis));
+
+  // Past about 85 degrees the cone hardly ever culls; keep the cutoff at 1.
+  if (min_dot <= 0.1f)
+    return meshlet;
+
+  meshlet.cone_axis = axis;
+  meshlet.cone_cutoff = std::sqrt(1.f - min_dot * min_dot);
+
+  return meshlet;
+}
+
+} // namespace
+
+auto build_meshlets(const std::span<const uint32_t> indices,
+                    const std::vector<VertexAttributes> &vertices,
+                    const bool cones) -> std::vector<Meshlet> {
+  std::vector<Meshlet> meshlets;
+
+  // The meshlet a vertex was last counted for.
+  std::vector<uint32_t> seen(vertices.size(),
+                             std::numeric_limits<uint32_t>::max());
+
+  uint32_t current = 0;
+  uint32_t first_index = 0;
+  uint32_t unique_vertices = 0;
+
+  for (uint32_t i = 0; i + 2 < indices.size(); i += 3) {
+    const auto a = indices[i];
+    const auto b = indices[i + 1];
+    const auto c = indices[i + 2];
+
+    const auto added = [&] {
+      return static_cast<uint32_t>(seen[a] != current) +
+             static_cast<uint32_t>(seen[b] != current && b != a) +
+             static_cast<uint32_t>(seen[c] != current && c != a && c != b);
+    };
+
+    if (unique_vertices + added() > max_meshlet_vertices ||
+        i - first_index == max_meshlet_triangles * 3) {
+      meshlets.push_back(
+          finish_meshlet(indices, vertices, first_index, i - first_index,
+                         cones));
+
+      current++;
+      first_index = i;
+      unique_vertices = 0;
+    }
+
+    unique_vertices += added();
+    seen[a] = seen[b] = seen[c] = current;
+  }
+
+  const auto end = static_cast<uint32_t>(indices.size() / 3 * 3);
+  if (end > first_index)
+    meshlets.push_back(finish_meshlet(indices, vertices, first_index,
+                                      end - first_index, cones));
+
+  return meshlets;
+}
+
+} // namespace mov
@@ -0,0 +1,95 @@
+#include <mov/PackedVertex.hpp>
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mov {
+
+auto octahedral_encode(const glm::vec3 normal) -> glm::vec2 {
+  const auto length =
+      glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+
+  // Importers leave zero normals on degenerate triangles and points; encode
+  // those as +z rather than passing the NaN on.
+  if (!(length > 0.f) || !std::isfinite(length))
+    return glm::vec2(0.f);
+
+  const auto n = normal / length;
+  const glm::vec2 xy(n);
+
+  if (n.z >= 0.f)
+    return xy;
+
+  // Fold the lower hemisphere over the diagonals.
+  const glm::vec2 sign(xy.x >= 0.f ? 1.f : -1.f, xy.y >= 0.f ? 1.f : -1.f);
+  return (1.f - glm::abs(glm::vec2(xy.y, xy.x))) * sign;
+}
+
+auto octahedral_decode(const glm::vec2 encoded) -> glm::vec3 {
+  glm::vec3 n(encoded, 1.f - glm::abs(encoded.x) - glm::abs(encoded.y));
+
+  const auto t = glm::max(-n.z, 0.f);
+  n.x += n.x >= 0.f ? -t : t;
+  n.y += n.y >= 0.f ? -t : t;
+
+  return glm::normalize(n);
+}
+
+auto pack_vertices(const std::vector<VertexAttributes> &vertices)
+    -> PackedVertices {
+  PackedVertices packed;
+
+  if (vertices.empty())
+    return packed;
+
+  auto min = vertices.front().position;
+  auto max = min;
+  for (const auto &vertex : vertices) {
+    min = glm::min(min, vertex.position);
+    max = glm::max(max, vertex.position);
+  }
+
+  // A flat axis keeps a scale of 1 so it does not divide by zero.
+  const auto extent = glm::max(max - min, glm::vec3(1e-6f));
+
+  packed.decode = glm::mat4(glm::vec4(extent.x, 0.f, 0.f, 0.f),
+                            glm::vec4(0.f, extent.y, 0.f, 0.f),
+                            glm::vec4(0.f, 0.f, extent.z, 0.f),
+                            glm::vec4(min, 1.f));
+
+  const auto unorm16 = [](const float value) {
+    return static_cast<uint16_t>(
+        std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+  };
+  const auto unorm8 = [](const float value) {
+    return static_cast<uint8_t>(
+        std::lround(std::clamp(value, 0.f, 1.f) * 255.f));
+  };
+  const auto snorm8 = [](const float value) {
+    return static_cast<int8_t>(
+        std::lround(std::clamp(value, -1.f, 1.f) * 127.f));
+  };
+
+  packed.vertices.reserve(vertices.size());
+
+  for (const auto &vertex : vertices) {
+    const auto position = (vertex.position - min) / extent;
+    const auto normal = octahedral_encode(vertex.normal);
+    const auto tangent = octahedral_encode(glm::vec3(vertex.tangent));
+
+    packed.vertices.push_back(
+        {{unorm16(position.x), unorm16(position.y), unorm16(position.z),
+          static_cast<uint16_t>(vertex.tangent.w < 0.f ? 0 : 65535)},
+         {unorm8(vertex.color.r), unorm8(vertex.color.g),
+          unorm8(vertex.color.b), 255},
+         {snorm8(normal.x), snorm8(normal.y), snorm8(tangent.x),
+          snorm8(tangent.y)},
+         glm::packHalf2x16(vertex.uv)});
+  }
+
+  return packed;
+}
+
+} // namespace mov
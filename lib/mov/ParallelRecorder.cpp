@@ -0,0 +1,155 @@
+#include <mov/ParallelRecorder.hpp>
+#include <mov/Tracer.hpp>
+
+#include <algorithm>
+
+namespace mov {
+
+ParallelRecorder::ParallelRecorder(const vk::Device device,
+                                   const uint32_t queue_family_index,
+                                   const uint32_t frame_count,
+                                   const uint32_t worker_count,
+                                   const uint32_t min_slice_size)
+    : device_(device), frame_count_(frame_count),
+      min_slice_size_(std::max(min_slice_size, 1u)),
+      workers_(std::max(worker_count, 1u)), slices_(workers_.size()) {
+  for (auto &worker : workers_) {
+    worker.buffers.resize(frame_count_);
+
+    for (uint32_t slot = 0; slot < frame_count_; slot++)
+      worker.pools.push_back(device_.createCommandPool(
+          {vk::CommandPoolCreateFlagBits::eTransient, queue_family_index}));
+  }
+
+  for (uint32_t i = 1; i < workers_.size(); i++)
+    threads_.emplace_back(&ParallelRecorder::run, this, i);
+}
+
+void ParallelRecorder::begin_frame(const uint32_t frame) {
+  slot_ = frame % frame_count_;
+
+  for (auto &worker : workers_) {
+    device_.resetCommandPool(worker.pools[slot_]);
+    worker.used = 0;
+  }
+}
+
+void ParallelRecorder::record(
+    const vk::CommandBuffer primary,
+    const vk::CommandBufferInheritanceInfo &inheritance,
+    const uint32_t item_count, const Record &record) {
+  if (item_count == 0)
+    return;
+
+  const auto started = std::chrono::steady_clock::now();
+
+  record_ = &record;
+  inheritance_ = &inheritance;
+  item_count_ = item_count;
+  slice_count_ = std::clamp(item_count / min_slice_size_, 1u,
+                            static_cast<uint32_t>(workers_.size()));
+
+  // Small jobs are not worth waking the workers for.
+  if (slice_count_ > 1) {
+    {
+      std::lock_guard lock(mutex_);
+      generation_++;
+      pending_ = static_cast<uint32_t>(threads_.size());
+    }
+    start_.notify_all();
+  }
+
+  record_slice(0);
+
+  if (slice_count_ > 1) {
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+  primary.executeCommands(slice_count_, slices_.data());
+
+  stats_.items += item_count;
+  stats_.slices += slice_count_;
+  stats_.recordings++;
+  stats_.busy += std::chrono::steady_clock::now() - started;
+}
+
+void ParallelRecorder::run(const uint32_t worker) {
+  if constexpr (tracing_enabled)
+    Tracer::get().set_thread_name("recorder " + std::to_string(worker));
+
+  uint64_t seen = 0;
+
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+
+      if (stopping_)
+        return;
+
+      seen = generation_;
+    }
+
+    if (worker < slice_count_)
+      record_slice(worker);
+
+    {
+      std::lock_guard lock(mutex_);
+      if (--pending_ == 0)
+        done_.notify_one();
+    }
+  }
+}
+
+void ParallelRecorder::record_slice(const uint32_t worker_index) {
+  MOV_TRACE_ZONE("record slice");
+
+  auto &worker = workers_[worker_index];
+  auto &buffers = worker.buffers[slot_];
+
+  if (worker.used == buffers.size())
+    buffers.push_back(device_.allocateCommandBuffers(
+        vk::CommandBufferAllocateInfo()
+            .setCommandPool(worker.pools[slot_])
+            .setLevel(vk::CommandBufferLevel::eSecondary)
+            .setCommandBufferCount(1))[0]);
+
+  const auto commands = buffers[worker.used++];
+
+  const auto begin = static_cast<uint32_t>(
+      static_cast<uint64_t>(item_count_) * worker_index / slice_count_);
+  const auto end = static_cast<uint32_t>(
+      static_cast<uint64_t>(item_count_) * (worker_index + 1) / slice_count_);
+
+  commands.begin(vk::CommandBufferBeginInfo()
+                     .setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                               vk::CommandBufferUsageFlagBits::
+                                   eRenderPassContinue)
+                     .setPInheritanceInfo(inheritance_));
+
+  (*record_)(commands, begin, end);
+
+  commands.end();
+
+  slices_[worker_index] = commands;
+}
+
+void ParallelRecorder::destroy() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+
+  for (auto &thread : threads_)
+    thread.join();
+  threads_.clear();
+
+  for (const auto &worker : workers_)
+    for (const auto pool : worker.pools)
+      device_.destroyCommandPool(pool);
+  workers_.clear();
+}
+
+} // namespace mov
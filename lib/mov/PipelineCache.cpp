@@ -0,0 +1,215 @@
+#include <mov/PipelineCache.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace mov {
+
+PipelineCache::PipelineCache(const vk::Device device,
+                             const vk::PhysicalDevice physical_device,
+                             std::filesystem::path path,
+                             const bool creation_feedback)
+    : device_(device), properties_(physical_device.getProperties()),
+      path_(std::move(path)), creation_feedback_(creation_feedback) {
+  const auto data = load();
+
+  cache_ = device_.createPipelineCache(
+      vk::PipelineCacheCreateInfo()
+          .setInitialDataSize(data.size())
+          .setPInitialData(data.empty() ? nullptr : data.data()));
+
+  stale_ = load_ != PipelineCacheLoad::Loaded;
+}
+
+auto PipelineCache::load() -> std::vector<std::byte> {
+  std::ifstream file(path_, std::ios::binary | std::ios::ate);
+  if (!file)
+    return {};
+
+  const auto file_size = static_cast<uint64_t>(file.tellg());
+  file.seekg(0, std::ios::beg);
+
+  FileHeader header{};
+  load_ = PipelineCacheLoad::Rejected;
+
+  if (file_size < sizeof header ||
+      !file.read(reinterpret_cast<char *>(&header), sizeof header))
+    return {};
+
+  if (header.magic != file_magic || header.version != file_version ||
+      header.data_size != file_size - sizeof header)
+    return {};
+
+  // The history stays useful across driver updates even when the blob
+  // itself does not.
+  history_misses_ = header.miss_count;
+  history_miss_time_ = std::chrono::nanoseconds(header.miss_nanoseconds);
+
+  if (header.driver_version != properties_.driverVersion)
+    return {};
+
+  std::vector<std::byte> data(header.data_size);
+  if (!file.read(reinterpret_cast<char *>(data.data()),
+                 static_cast<std::streamsize>(data.size())) ||
+      !matches_device(data))
+    return {};
+
+  load_ = PipelineCacheLoad::Loaded;
+
+  return data;
+}
+
+auto PipelineCache::matches_device(const std::vector<std::byte> &data) const
+    -> bool {
+  // vkCreatePipelineCache is allowed to ignore incompatible data, but some
+  // drivers have crashed on it, so never hand over a foreign blob.
+  struct {
+    uint32_t header_size;
+    vk::PipelineCacheHeaderVersion header_version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint8_t uuid[VK_UUID_SIZE];
+  } header{};
+
+  if (data.size() < sizeof header)
+    return false;
+
+  std::memcpy(&header, data.data(), sizeof header);
+
+  return header.header_size >= sizeof header &&
+         header.header_version == vk::PipelineCacheHeaderVersion::eOne &&
+         header.vendor_id == properties_.vendorID &&
+         header.device_id == properties_.deviceID &&
+         std::memcmp(header.uuid, properties_.pipelineCacheUUID.data(),
+                     VK_UUID_SIZE) == 0;
+}
+
+auto PipelineCache::create_graphics_pipeline(
+    const vk::GraphicsPipelineCreateInfo &create_info)
+    -> vk::ResultValue<vk::Pipeline> {
+  vk::PipelineCreationFeedbackEXT feedback{};
+  vk::PipelineCreationFeedbackCreateInfoEXT feedback_info{};
+  feedback_info.setPPipelineCreationFeedback(&feedback)
+      .setPNext(create_info.pNext);
+
+  auto chained = create_info;
+  if (creation_feedback_)
+    chained.setPNext(&feedback_info);
+
+  const auto started = std::chrono::steady_clock::now();
+  auto result = device_.createGraphicsPipeline(cache_, chained);
+  record(std::chrono::steady_clock::now() - started, feedback);
+
+  return result;
+}
+
+auto PipelineCache::create_compute_pipeline(
+    const vk::ComputePipelineCreateInfo &create_info)
+    -> vk::ResultValue<vk::Pipeline> {
+  vk::PipelineCreationFeedbackEXT feedback{};
+  vk::PipelineCreationFeedbackCreateInfoEXT feedback_info{};
+  feedback_info.setPPipelineCreationFeedback(&feedback)
+      .setPNext(create_info.pNext);
+
+  auto chained = create_info;
+  if (creation_feedback_)
+    chained.setPNext(&feedback_info);
+
+  const auto started = std::chrono::steady_clock::now();
+  auto result = device_.createComputePipeline(cache_, chained);
+  record(std::chrono::steady_clock::now() - started, feedback);
+
+  return result;
+}
+
+void PipelineCache::record(const std::chrono::nanoseconds duration,
+                           const vk::PipelineCreationFeedbackEXT &feedback) {
+  pipelines_++;
+  creation_ += duration;
+
+  if (!(feedback.flags & vk::PipelineCreationFeedbackFlagBitsEXT::eValid)) {
+    stale_ = true;
+    return;
+  }
+
+  if (feedback.flags &
+      vk::PipelineCreationFeedbackFlagBitsEXT::eApplicationPipelineCacheHit) {
+    hits_++;
+    hit_time_ += duration;
+  } else {
+    misses_++;
+    miss_time_ += duration;
+    stale_ = true;
+  }
+}
+
+auto PipelineCache::save() -> bool {
+  if (!stale_)
+    return true;
+
+  const auto data = device_.getPipelineCacheData(cache_);
+
+  const FileHeader header{
+      file_magic,
+      file_version,
+      properties_.driverVersion,
+      0,
+      data.size(),
+      history_misses_ + misses_,
+      static_cast<uint64_t>((history_miss_time_ + miss_time_).count())};
+
+  auto temporary = path_;
+  temporary += ".tmp";
+
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof header);
+    file.write(reinterpret_cast<const char *>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    file.flush();
+
+    if (!file)
+      return false;
+  }
+
+  // Replacing the file by renaming is atomic, unlike rewriting it in place.
+  std::error_code error;
+  std::filesystem::rename(temporary, path_, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+
+  // The history is now part of the file, so it must not be added twice.
+  history_misses_ += misses_;
+  history_miss_time_ += miss_time_;
+  misses_ = 0;
+  miss_time_ = {};
+  stale_ = false;
+
+  return true;
+}
+
+auto PipelineCache::stats() const -> PipelineCacheStats {
+  PipelineCacheStats stats{};
+  stats.pipelines = pipelines_;
+  stats.hits = hits_;
+  stats.feedback = creation_feedback_;
+  stats.creation = creation_;
+
+  const auto misses = history_misses_ + misses_;
+  if (misses > 0 && hits_ > 0) {
+    const auto average_miss =
+        (history_miss_time_ + miss_time_) / static_cast<int64_t>(misses);
+    stats.saved = std::max(std::chrono::nanoseconds{0},
+                           average_miss * hits_ - hit_time_);
+  }
+
+  return stats;
+}
+
+void PipelineCache::destroy() { device_.destroyPipelineCache(cache_); }
+
+} // namespace mov
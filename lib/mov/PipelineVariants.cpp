@@ -0,0 +1,188 @@
+#include <mov/PipelineVariants.hpp>
+#include <mov/Vertex.hpp>
+
+#include <array>
+#include <functional>
+
+namespace mov {
+
+auto PipelineKeyHash::operator()(const PipelineKey &key) const -> size_t {
+  size_t seed = 0;
+  const auto combine = [&seed](auto value) {
+    seed ^= std::hash<decltype(value)>{}(value) + 0x9e3779b9 + (seed << 6) +
+            (seed >> 2);
+  };
+
+  combine(static_cast<VkRenderPass>(key.render_pass));
+  combine(static_cast<VkPipelineLayout>(key.layout));
+  combine(key.view_count);
+  combine(static_cast<uint32_t>(key.vertex_format));
+  combine(key.instanced);
+  combine(key.vertex_color);
+  combine(static_cast<uint32_t>(key.topology));
+  combine(static_cast<uint32_t>(key.polygon_mode));
+  combine(static_cast<uint32_t>(key.cull_mode));
+  combine(key.depth_write);
+  combine(key.blend);
+
+  return seed;
+}
+
+PipelineVariants::PipelineVariants(const vk::Device device,
+                                   PipelineCache &pipeline_cache,
+                                   ShaderRegistry &shaders)
+    : device_(device), pipeline_cache_(&pipeline_cache), shaders_(&shaders) {}
+
+auto PipelineVariants::get(const PipelineKey &key) -> vk::Pipeline {
+  lookups_++;
+
+  if (const auto pipeline = pipelines_.find(key); pipeline != pipelines_.end())
+    return pipeline->second;
+
+  return pipelines_[key] = create(key);
+}
+
+auto PipelineVariants::shader(const std::string &name) -> vk::ShaderModule {
+  auto &shader_module = modules_[name];
+  if (!shader_module)
+    shader_module = shaders_->create_module(device_, name);
+
+  return shader_module;
+}
+
+auto PipelineVariants::create(const PipelineKey &key) -> vk::Pipeline {
+  const auto float_attributes = Vertex::get_attribute_descriptions();
+  const auto packed_attributes = PackedVertex::get_attribute_descriptions();
+  const auto packed = key.vertex_format == VertexFormat::Packed;
+
+  const auto binding_description =
+      packed ? PackedVertex::get_binding_description()
+             : Vertex::get_binding_description();
+
+  vk::PipelineVertexInputStateCreateInfo vertex_input_stage{};
+  vertex_input_stage.setVertexBindingDescriptions(binding_description);
+  if (packed)
+    vertex_input_stage.setVertexAttributeDescriptions(packed_attributes);
+  else
+    vertex_input_stage.setVertexAttributeDescriptions(float_attributes);
+
+  vk::PipelineInputAssemblyStateCreateInfo input_assembly_stage{};
+  input_assembly_stage.setTopology(key.topology)
+      .setPrimitiveRestartEnable(false);
+
+  const std::array<vk::Bool32, 2> constants = {key.instanced,
+                                               key.vertex_color};
+  const std::array<vk::SpecializationMapEntry, 2> specialization_entries = {
+      vk::SpecializationMapEntry{0, 0, sizeof(vk::Bool32)},
+      vk::SpecializationMapEntry{1, sizeof(vk::Bool32), sizeof(vk::Bool32)}};
+
+  vk::SpecializationInfo specialization_info{};
+  specialization_info.setMapEntries(specialization_entries)
+      .setDataSize(sizeof constants)
+      .setPData(constants.data());
+
+  vk::PipelineShaderStageCreateInfo vertex_shader_stage{};
+  vertex_shader_stage.setStage(vk::ShaderStageFlagBits::eVertex)
+      .setModule(shader(key.view_count > 1 ? "vertex.vert"
+                                           : "vertex.single.vert"))
+      .setPName("main")
+      .setPSpecializationInfo(&specialization_info);
+
+  vk::PipelineShaderStageCreateInfo fragment_shader_stage{};
+  fragment_shader_stage.setStage(vk::ShaderStageFlagBits::eFragment)
+      .setModule(shader("fragment.frag"))
+      .setPName("main");
+
+  // Viewport and scissor are dynamic state.
+  vk::PipelineViewportStateCreateInfo viewport_stage{};
+  viewport_stage.setViewportCount(1).setScissorCount(1);
+
+  vk::PipelineRasterizationStateCreateInfo rasterization_stage{};
+  rasterization_stage.setDepthClampEnable(false)
+      .setRasterizerDiscardEnable(false)
+      .setPolygonMode(key.polygon_mode)
+      .setLineWidth(1)
+      .setCullMode(key.cull_mode)
+      .setFrontFace(vk::FrontFace::eCounterClockwise)
+      .setDepthBiasEnable(false);
+
+  vk::PipelineMultisampleStateCreateInfo multisample_stage{};
+  multisample_stage.setRasterizationSamples(vk::SampleCountFlagBits::e1)
+      .setSampleShadingEnable(false);
+
+  vk::PipelineDepthStencilStateCreateInfo depth_stencil_stage{};
+  depth_stencil_stage.setDepthTestEnable(true)
+      .setDepthWriteEnable(key.depth_write)
+      .setDepthCompareOp(vk::CompareOp::eLess)
+      .setDepthBoundsTestEnable(false)
+      .setMinDepthBounds(0)
+      .setMaxDepthBounds(1)
+      .setStencilTestEnable(false);
+
+  vk::PipelineColorBlendAttachmentState color_blend_attachment{};
+  color_blend_attachment
+      .setColorWriteMask(
+          vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+          vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA)
+      .setBlendEnable(key.blend)
+      .setSrcColorBlendFactor(vk::BlendFactor::eSrcAlpha)
+      .setDstColorBlendFactor(vk::BlendFactor::eOneMinusSrcAlpha)
+      .setColorBlendOp(vk::BlendOp::eAdd)
+      .setSrcAlphaBlendFactor(vk::BlendFactor::eOne)
+      .setDstAlphaBlendFactor(vk::BlendFactor::eOne)
+      .setAlphaBlendOp(vk::BlendOp::eAdd);
+
+  vk::PipelineColorBlendStateCreateInfo color_blend_stage{};
+  color_blend_stage.setLogicOpEnable(false)
+      .setLogicOp(vk::LogicOp::eCopy)
+      .setAttachments(color_blend_attachment)
+      .setBlendConstants(std::array{0.f, 0.f, 0.f, 0.f});
+
+  const vk::DynamicState dynamic_states[] = {vk::DynamicState::eViewport,
+                                             vk::DynamicState::eScissor};
+
+  vk::PipelineDynamicStateCreateInfo dynamic_state{};
+  dynamic_state.setDynamicStates(dynamic_states);
+
+  const vk::PipelineShaderStageCreateInfo shader_stages[] = {
+      vertex_shader_stage, fragment_shader_stage};
+
+  vk::GraphicsPipelineCreateInfo create_info{};
+  create_info.setStages(shader_stages)
+      .setPVertexInputState(&vertex_input_stage)
+      .setPInputAssemblyState(&input_assembly_stage)
+      .setPViewportState(&viewport_stage)
+      .setPRasterizationState(&rasterization_stage)
+      .setPMultisampleState(&multisample_stage)
+      .setPDepthStencilState(&depth_stencil_stage)
+      .setPColorBlendState(&color_blend_stage)
+      .setPDynamicState(&dynamic_state)
+      .setLayout(key.layout)
+      .setRenderPass(key.render_pass)
+      .setSubpass(0)
+      .setBasePipelineIndex(-1);
+
+  const auto result = pipeline_cache_->create_graphics_pipeline(create_info);
+
+  if (result.result != vk::Result::eSuccess)
+    throw std::runtime_error("Failed to create a pipeline variant: " +
+                             vk::to_string(result.result));
+
+  return result.value;
+}
+
+auto PipelineVariants::stats() const -> PipelineVariantStats {
+  return {static_cast<uint32_t>(pipelines_.size()), lookups_};
+}
+
+void PipelineVariants::destroy() {
+  for (const auto &[key, pipeline] : pipelines_)
+    device_.destroyPipeline(pipeline);
+  for (const auto &[name, shader_module] : modules_)
+    device_.destroyShaderModule(shader_module);
+
+  pipelines_.clear();
+  modules_.clear();
+}
+
+} // namespace mov
@@ -0,0 +1,58 @@
+#include <mov/ShaderRegistry.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mov {
+
+ShaderRegistry::ShaderRegistry(const std::span<const EmbeddedShader> shaders,
+                               std::filesystem::path override_directory)
+    : shaders_(shaders), override_directory_(std::move(override_directory)) {}
+
+auto ShaderRegistry::find(const std::string_view name) const
+    -> std::span<const uint32_t> {
+  const auto shader = std::ranges::find(shaders_, name, &EmbeddedShader::name);
+
+  return shader == shaders_.end() ? std::span<const uint32_t>{} : shader->code;
+}
+
+auto ShaderRegistry::create_module(const vk::Device device,
+                                   const std::string_view name)
+    -> vk::ShaderModule {
+  if (!override_directory_.empty()) {
+    const auto path = override_directory_ / (std::string(name) + ".spv");
+
+    // Only the shaders being worked on need to be in the directory.
+    if (std::filesystem::exists(path)) {
+      std::ifstream file(path, std::ios::binary | std::ios::ate);
+      const auto file_size = static_cast<size_t>(file.tellg());
+      file.seekg(0, std::ios::beg);
+
+      if (!file || file_size == 0 || file_size % sizeof(uint32_t) != 0)
+        throw std::runtime_error("Invalid SPIR-V in " + path.string() + "!");
+
+      std::vector<uint32_t> code(file_size / sizeof(uint32_t));
+      if (!file.read(reinterpret_cast<char *>(code.data()),
+                     static_cast<std::streamsize>(file_size)))
+        throw std::runtime_error("Failed to read " + path.string() + "!");
+
+      overridden_++;
+
+      return device.createShaderModule(
+          vk::ShaderModuleCreateInfo().setCode(code));
+    }
+  }
+
+  const auto code = find(name);
+  if (code.empty())
+    throw std::runtime_error("No shader named " + std::string(name) + "!");
+
+  return device.createShaderModule(vk::ShaderModuleCreateInfo()
+                                       .setCodeSize(code.size_bytes())
+                                       .setPCode(code.data()));
+}
+
+} // namespace mov
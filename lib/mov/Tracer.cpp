@@ -0,0 +1,183 @@
+#include <mov/Tracer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string_view>
+
+namespace mov {
+
+// The fields are atomic so that a writer copying an event while its thread
+// overwrites it reads a mix of old and new values, not undefined behaviour.
+struct TraceSlot {
+  std::atomic<const char *> name{nullptr};
+  std::atomic<int64_t> begin{0};
+  std::atomic<int64_t> end{0};
+};
+
+struct Tracer::Buffer {
+  uint32_t thread{0};
+  std::string name;
+
+  std::unique_ptr<TraceSlot[]> events{new TraceSlot[buffer_capacity]};
+  // Events ever recorded; the next one goes to head % buffer_capacity.
+  std::atomic<uint64_t> head{0};
+};
+
+namespace {
+
+void write_string(std::ostream &out, const std::string_view string) {
+  out << '"';
+  for (const auto c : string) {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+          << static_cast<int>(c) << std::dec << std::setfill(' ');
+    else
+      out << c;
+  }
+  out << '"';
+}
+
+// Chrome traces are in microseconds; keep the nanoseconds as decimals.
+void write_time(std::ostream &out, const int64_t nanoseconds) {
+  out << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0')
+      << nanoseconds % 1000 << std::setfill(' ');
+}
+
+} // namespace
+
+Tracer::Tracer() : start_(std::chrono::steady_clock::now()) {}
+
+Tracer::~Tracer() = default;
+
+auto Tracer::get() -> Tracer & {
+  static Tracer tracer;
+  return tracer;
+}
+
+auto Tracer::buffer() -> Buffer & {
+  // Buffers belong to the tracer, so events outlive the threads that
+  // recorded them.
+  thread_local Buffer *current = nullptr;
+
+  if (!current) {
+    std::scoped_lock lock(mutex_);
+
+    auto &buffer = buffers_.emplace_back(std::make_unique<Buffer>());
+    buffer->thread = static_cast<uint32_t>(buffers_.size());
+    buffer->name = "thread " + std::to_string(buffer->thread);
+    current = buffer.get();
+  }
+
+  return *current;
+}
+
+void Tracer::record(const char *name, const int64_t begin,
+                    const int64_t end) {
+  auto &buffer = this->buffer();
+
+  const auto head = buffer.head.load(std::memory_order_relaxed);
+  auto &slot = buffer.events[head % buffer_capacity];
+
+  // Pairs with the acquire fence in write_chrome_trace: a writer that sees
+  // any of these fields also sees every earlier head.
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.begin.store(begin, std::memory_order_relaxed);
+  slot.end.store(end, std::memory_order_relaxed);
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::set_thread_name(std::string name) {
+  auto &buffer = this->buffer();
+
+  std::scoped_lock lock(mutex_);
+  buffer.name = std::move(name);
+}
+
+auto Tracer::write_chrome_trace(const std::filesystem::path &path) const
+    -> uint64_t {
+  std::ofstream out(path);
+  if (!out)
+    throw std::runtime_error("Failed to open trace file!");
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+  uint64_t written = 0;
+  std::vector<TraceEvent> events;
+
+  std::scoped_lock lock(mutex_);
+
+  for (const auto &buffer : buffers_) {
+    if (buffer != buffers_.front())
+      out << ',';
+
+    out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << buffer->thread << ",\"args\":{\"name\":";
+    write_string(out, buffer->name);
+    out << "}}";
+
+    const auto head = buffer->head.load(std::memory_order_acquire);
+    const auto oldest = head > buffer_capacity ? head - buffer_capacity : 0;
+
+    events.clear();
+    for (auto i = oldest; i < head; i++) {
+      const auto &slot = buffer->events[i % buffer_capacity];
+      events.push_back({slot.name.load(std::memory_order_relaxed),
+                        slot.begin.load(std::memory_order_relaxed),
+                        slot.end.load(std::memory_order_relaxed)});
+    }
+
+    // The thread kept recording while the events were copied; any it has
+    // overwritten since, or is overwriting now, may be torn. The fence makes
+    // the head read below at least as new as any overwrite that was copied.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto later = buffer->head.load(std::memory_order_relaxed) + 1;
+    const auto valid = later > buffer_capacity ? later - buffer_capacity : 0;
+
+    for (auto i = std::max(oldest, valid); i < head; i++) {
+      const auto &event = events[i - oldest];
+
+      out << ",\n{\"name\":";
+      write_string(out, event.name);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+          << ",\"ts\":";
+      write_time(out, event.begin);
+      out << ",\"dur\":";
+      write_time(out, event.end - event.begin);
+      out << '}';
+
+      written++;
+    }
+  }
+
+  out << "\n]}\n";
+
+  if (!out)
+    throw std::runtime_error("Failed to write trace file!");
+
+  return written;
+}
+
+auto Tracer::stats() const -> TraceStats {
+  std::scoped_lock lock(mutex_);
+
+  TraceStats stats{};
+  stats.threads = static_cast<uint32_t>(buffers_.size());
+
+  for (const auto &buffer : buffers_) {
+    const auto head = buffer->head.load(std::memory_order_acquire);
+
+    stats.events += head;
+    stats.overwritten += head > buffer_capacity ? head - buffer_capacity : 0;
+  }
+
+  return stats;
+}
+
+} // namespace mov
@@ -0,0 +1,43 @@
+#include <mov/FreeList.hpp>
+#include <mov/UniformRing.hpp>
+
+namespace mov {
+
+UniformRing::UniformRing(VkAllocator &allocator, const uint32_t frame_count,
+                         const vk::DeviceSize frame_capacity)
+    : allocator_(&allocator),
+      alignment_(allocator.physical_device()
+                     .getProperties()
+                     .limits.minUniformBufferOffsetAlignment),
+      frame_capacity_(FreeList::align_up(frame_capacity, alignment_)),
+      frame_count_(frame_count) {
+  std::tie(buffer_, allocation_) = allocator.create_buffer(
+      frame_capacity_ * frame_count_, vk::BufferUsageFlagBits::eUniformBuffer,
+      vk::MemoryPropertyFlagBits::eHostVisible |
+          vk::MemoryPropertyFlagBits::eHostCoherent,
+      MemoryCategory::Uniforms);
+}
+
+void UniformRing::begin_frame(const uint32_t frame) {
+  frame_begin_ = (frame % frame_count_) * frame_capacity_;
+  cursor_ = frame_begin_;
+}
+
+auto UniformRing::allocate(const vk::DeviceSize size)
+    -> std::tuple<void *, uint32_t> {
+  const auto offset = cursor_;
+
+  if (offset + size > frame_begin_ + frame_capacity_)
+    throw std::runtime_error("Uniform ring frame capacity exceeded!");
+
+  cursor_ = FreeList::align_up(offset + size, alignment_);
+
+  return {static_cast<std::byte *>(allocation_.mapped) + offset,
+          static_cast<uint32_t>(offset)};
+}
+
+void UniformRing::destroy() {
+  allocator_->destroy_buffer(buffer_, allocation_);
+}
+
+} // namespace mov
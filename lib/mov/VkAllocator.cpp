@@ -0,0 +1,200 @@
+#include <mov/VkAllocator.hpp>
+#include <mov/VkUtils.hpp>
+
+#include <algorithm>
+
+namespace mov {
+
+VkAllocator::VkAllocator(const vk::Device device,
+                         const vk::PhysicalDevice physical_device,
+                         const vk::DeviceSize block_size)
+    : device_(device), physical_device_(physical_device),
+      memory_properties_(physical_device.getMemoryProperties()),
+      block_size_(block_size),
+      pools_(memory_properties_.memoryTypeCount * 2) {}
+
+auto VkAllocator::block_size_for(const uint32_t memory_type) const
+    -> vk::DeviceSize {
+  const auto heap_index =
+      memory_properties_.memoryTypes[memory_type].heapIndex;
+  const auto heap_size = memory_properties_.memoryHeaps[heap_index].size;
+
+  // Small heaps (e.g. the 256 MiB host-visible BAR window) must not be eaten
+  // by a single block.
+  return std::min(block_size_, heap_size / 8);
+}
+
+auto VkAllocator::create_block(const uint32_t memory_type,
+                               const vk::DeviceSize size) -> Block {
+  Block block{};
+  block.memory = device_.allocateMemory(vk::MemoryAllocateInfo()
+                                            .setAllocationSize(size)
+                                            .setMemoryTypeIndex(memory_type));
+  block.ranges = FreeList(size);
+
+  heap_usage_[memory_properties_.memoryTypes[memory_type].heapIndex] += size;
+
+  if (memory_properties_.memoryTypes[memory_type].propertyFlags &
+      vk::MemoryPropertyFlagBits::eHostVisible)
+    block.mapped =
+        static_cast<std::byte *>(device_.mapMemory(block.memory, 0, size));
+
+  return block;
+}
+
+void VkAllocator::release_block(const uint32_t memory_type,
+                                const Block &block) {
+  heap_usage_[memory_properties_.memoryTypes[memory_type].heapIndex] -=
+      block.ranges.capacity();
+
+  device_.freeMemory(block.memory);
+}
+
+auto VkAllocator::allocate(const vk::MemoryRequirements &requirements,
+                           const vk::MemoryPropertyFlags properties,
+                           const MemoryCategory category, const bool linear)
+    -> VkAllocation {
+  const auto memory_type = find_memory_type(
+      physical_device_, requirements.memoryTypeBits, properties);
+
+  auto &pool = pools_[pool_index(memory_type, linear)];
+
+  const auto make_allocation = [&](Block &block, const vk::DeviceSize offset) {
+    block.allocation_count++;
+
+    const auto index = static_cast<uint32_t>(category);
+    category_usage_[index] += requirements.size;
+    category_peak_[index] =
+        std::max(category_peak_[index], category_usage_[index]);
+
+    return VkAllocation{block.memory,
+                        offset,
+                        requirements.size,
+                        block.mapped ? block.mapped + offset : nullptr,
+                        memory_type,
+                        linear,
+                        category};
+  };
+
+  for (auto &block : pool.blocks)
+    if (const auto offset =
+            block.ranges.allocate(requirements.size, requirements.alignment))
+      return make_allocation(block, *offset);
+
+  const auto block_size =
+      std::max(block_size_for(memory_type), requirements.size);
+
+  auto &block = pool.blocks.emplace_back(create_block(memory_type, block_size));
+
+  return make_allocation(
+      block, *block.ranges.allocate(requirements.size, requirements.alignment));
+}
+
+void VkAllocator::free(const VkAllocation &allocation) {
+  if (!allocation.memory)
+    return;
+
+  auto &pool = pools_[pool_index(allocation.memory_type, allocation.linear)];
+
+  const auto block =
+      std::ranges::find(pool.blocks, allocation.memory, &Block::memory);
+
+  if (block == pool.blocks.end())
+    throw std::runtime_error("Freeing an allocation not owned by allocator!");
+
+  block->ranges.free(allocation.offset, allocation.size);
+  block->allocation_count--;
+
+  category_usage_[static_cast<uint32_t>(allocation.category)] -=
+      allocation.size;
+
+  // Keep one empty block per pool around so a load/unload cycle does not
+  // bounce a whole block through vkAllocateMemory.
+  if (block->allocation_count == 0 && pool.blocks.size() > 1) {
+    release_block(allocation.memory_type, *block);
+    pool.blocks.erase(block);
+  }
+}
+
+auto VkAllocator::create_buffer(const vk::DeviceSize size,
+                                const vk::BufferUsageFlags usage,
+                                const vk::MemoryPropertyFlags properties,
+                                const MemoryCategory category)
+    -> std::tuple<vk::Buffer, VkAllocation> {
+  const auto buffer = device_.createBuffer(
+      vk::BufferCreateInfo().setSize(size).setUsage(usage).setSharingMode(
+          vk::SharingMode::eExclusive));
+
+  const auto allocation = allocate(device_.getBufferMemoryRequirements(buffer),
+                                   properties, category, true);
+  device_.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+
+  return {buffer, allocation};
+}
+
+auto VkAllocator::create_image(const vk::ImageCreateInfo &create_info,
+                               const vk::MemoryPropertyFlags properties,
+                               const MemoryCategory category)
+    -> std::tuple<vk::Image, VkAllocation> {
+  const auto image = device_.createImage(create_info);
+
+  const auto allocation =
+      allocate(device_.getImageMemoryRequirements(image), properties, category,
+               create_info.tiling == vk::ImageTiling::eLinear);
+  device_.bindImageMemory(image, allocation.memory, allocation.offset);
+
+  return {image, allocation};
+}
+
+void VkAllocator::destroy_buffer(const vk::Buffer buffer,
+                                 const VkAllocation &allocation) {
+  device_.destroyBuffer(buffer);
+  free(allocation);
+}
+
+void VkAllocator::destroy_image(const vk::Image image,
+                                const VkAllocation &allocation) {
+  device_.destroyImage(image);
+  free(allocation);
+}
+
+void VkAllocator::accumulate(VkAllocatorStats &stats, const Pool &pool) {
+  for (const auto &block : pool.blocks) {
+    stats.block_count++;
+    stats.allocation_count += block.allocation_count;
+    stats.free_range_count += block.ranges.free_range_count();
+    stats.reserved += block.ranges.capacity();
+    stats.used += block.ranges.used();
+    stats.largest_free =
+        std::max(stats.largest_free, block.ranges.largest_free());
+  }
+}
+
+auto VkAllocator::stats() const -> VkAllocatorStats {
+  VkAllocatorStats stats{};
+
+  for (const auto &pool : pools_)
+    accumulate(stats, pool);
+
+  return stats;
+}
+
+auto VkAllocator::stats(const uint32_t memory_type) const -> VkAllocatorStats {
+  VkAllocatorStats stats{};
+
+  accumulate(stats, pools_[pool_index(memory_type, true)]);
+  accumulate(stats, pools_[pool_index(memory_type, false)]);
+
+  return stats;
+}
+
+void VkAllocator::destroy() {
+  for (uint32_t i = 0; i < pools_.size(); i++) {
+    for (const auto &block : pools_[i].blocks)
+      release_block(i / 2, block);
+
+    pools_[i].blocks.clear();
+  }
+}
+
+}; // namespace mov
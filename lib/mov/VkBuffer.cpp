@@ -7,101 +7,79 @@ namespace mov {
 
 auto VkBufferProvider::create_buffer(
     const vk::DeviceSize size, const vk::BufferUsageFlags usage,
-    const vk::MemoryPropertyFlags properties) const
-    -> std::tuple<vk::Buffer, vk::DeviceMemory> {
-  const auto buffer = device_.createBuffer(
-      vk::BufferCreateInfo().setSize(size).setUsage(usage).setSharingMode(
-          vk::SharingMode::eExclusive));
-
-  const auto requirements = device_.getBufferMemoryRequirements(buffer);
-
-  const auto memory = device_.allocateMemory(
-      vk::MemoryAllocateInfo()
-          .setAllocationSize(requirements.size)
-          .setMemoryTypeIndex(find_memory_type(
-              physical_device_, requirements.memoryTypeBits, properties)));
-  device_.bindBufferMemory(buffer, memory, 0);
-
-  return {buffer, memory};
+    const vk::MemoryPropertyFlags properties,
+    const MemoryCategory category) const
+    -> std::tuple<vk::Buffer, VkAllocation> {
+  return allocator_->create_buffer(size, usage, properties, category);
 }
 
-auto VkBufferProvider::copy_buffer(const vk::Buffer src, const vk::Buffer dst,
-                                   const vk::DeviceSize size) const {
-  const auto command_buffer = device_.allocateCommandBuffers(
-      vk::CommandBufferAllocateInfo()
-          .setLevel(vk::CommandBufferLevel::ePrimary)
-          .setCommandPool(command_pool_)
-          .setCommandBufferCount(1))[0];
-
-  command_buffer.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
-
-  vk::BufferCopy copy_region{};
-  copy_region.setSrcOffset(0).setDstOffset(0).setSize(size);
-  command_buffer.copyBuffer(src, dst, copy_region);
+void VkBufferProvider::destroy_buffer(const vk::Buffer buffer,
+                                      const VkAllocation &allocation) const {
+  allocator_->destroy_buffer(buffer, allocation);
+}
 
-  command_buffer.end();
+void VkBufferProvider::copy_buffer(const vk::Buffer src, const vk::Buffer dst,
+                                   const vk::DeviceSize size) const {
+  uploader_->copy(src, dst, vk::BufferCopy(0, 0, size));
+}
 
-  queue_.submit(vk::SubmitInfo().setCommandBuffers(command_buffer));
-  queue_.waitIdle();
+void VkBufferProvider::copy_buffer(const vk::Buffer src, const vk::Buffer dst,
+                                   const vk::BufferCopy &region) const {
+  uploader_->copy(src, dst, region);
+}
 
-  device_.freeCommandBuffers(command_pool_, command_buffer);
+void VkBufferProvider::upload(const vk::Buffer dst, const vk::DeviceSize offset,
+                              const void *data,
+                              const vk::DeviceSize size) const {
+  uploader_->upload(dst, offset, data, size);
 }
 
 template <typename T>
 auto create_buffer(const VkBufferProvider provider,
                    const vk::BufferUsageFlags usage, const T *data,
                    const std::size_t count)
-    -> std::tuple<vk::Buffer, vk::DeviceMemory> {
+    -> std::tuple<vk::Buffer, VkAllocation> {
   const vk::DeviceSize buffer_size = sizeof data[0] * count;
 
-  const auto [staging_buffer, staging_memory] =
-      provider.create_buffer(buffer_size, vk::BufferUsageFlagBits::eTransferSrc,
-                             vk::MemoryPropertyFlagBits::eHostVisible |
-                                 vk::MemoryPropertyFlagBits::eHostCoherent);
-
-  const auto dest = device(provider).mapMemory(staging_memory, 0, buffer_size);
-  memcpy_s(dest, buffer_size, data, buffer_size);
-  device(provider).unmapMemory(staging_memory);
-
-  const auto [buffer, memory] = provider.create_buffer(
+  const auto [buffer, allocation] = provider.create_buffer(
       buffer_size, vk::BufferUsageFlagBits::eTransferDst | usage,
-      vk::MemoryPropertyFlagBits::eDeviceLocal);
-  provider.copy_buffer(staging_buffer, buffer, buffer_size);
-
-  device(provider).destroyBuffer(staging_buffer);
-  device(provider).freeMemory(staging_memory);
+      vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Geometry);
+  provider.upload(buffer, 0, data, buffer_size);
 
-  return {buffer, memory};
+  return {buffer, allocation};
 }
 
 VkBuffer<Vertex>::VkBuffer(const VkBufferProvider provider,
                            const vk::BufferUsageFlags usage, const Vertex *data,
                            const std::size_t count)
     : provider_(provider) {
-  auto [dst_buffer, dst_memory] = create_buffer(provider, usage, data, count);
+  auto [dst_buffer, dst_allocation] =
+      create_buffer(provider, usage, data, count);
 
   buffer = dst_buffer;
-  memory = dst_memory;
+  allocation = dst_allocation;
 }
 
 VkBuffer<uint16_t>::VkBuffer(const VkBufferProvider provider,
                              const vk::BufferUsageFlags usage,
                              const uint16_t *data, const std::size_t count)
     : provider_(provider) {
-  auto [dst_buffer, dst_memory] = create_buffer(provider, usage, data, count);
+  auto [dst_buffer, dst_allocation] =
+      create_buffer(provider, usage, data, count);
 
   buffer = dst_buffer;
-  memory = dst_memory;
+  allocation = dst_allocation;
 }
 
 VkBuffer<uint32_t>::VkBuffer(const VkBufferProvider provider,
                              const vk::BufferUsageFlags usage,
                              const uint32_t *data, const std::size_t count)
     : provider_(provider) {
-  auto [dst_buffer, dst_memory] = create_buffer(provider, usage, data, count);
+  auto [dst_buffer, dst_allocation] =
+      create_buffer(provider, usage, data, count);
 
   buffer = dst_buffer;
-  memory = dst_memory;
+  allocation = dst_allocation;
 }
 
 } // namespace mov
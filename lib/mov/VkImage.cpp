@@ -1,16 +1,17 @@
 #include <mov/VkImage.hpp>
-#include <mov/VkUtils.hpp>
 
 namespace mov {
 
 auto VkImage::create_view(const vk::Device device, const vk::Image image,
                           const vk::Format format,
-                          const vk::ImageAspectFlags aspect) -> vk::ImageView
+                          const vk::ImageAspectFlags aspect,
+                          const uint32_t layers) -> vk::ImageView
 {
   const auto image_view_info =
       vk::ImageViewCreateInfo()
           .setImage(image)
-          .setViewType(vk::ImageViewType::e2D)
+          .setViewType(layers > 1 ? vk::ImageViewType::e2DArray
+                                  : vk::ImageViewType::e2D)
           .setFormat(format)
           .setComponents(vk::ComponentMapping()
                              .setR(vk::ComponentSwizzle::eIdentity)
@@ -22,7 +23,7 @@ auto VkImage::create_view(const vk::Device device, const vk::Image image,
                                    .setBaseMipLevel(0)
                                    .setLevelCount(1)
                                    .setBaseArrayLayer(0)
-                                   .setLayerCount(1));
+                                   .setLayerCount(layers));
 
   return device.createImageView(image_view_info);
 }
@@ -52,19 +53,20 @@ auto VkImage::create_sampler(const vk::Device device,
   return device.createSampler(sampler_info);
 }
 
-VkImage::VkImage(const vk::Device device,
-                 const vk::PhysicalDevice physical_device, const uint32_t width,
+VkImage::VkImage(VkAllocator &allocator, const uint32_t width,
                  const uint32_t height, const vk::Format format,
                  const vk::ImageTiling tiling,
                  const vk::ImageAspectFlags aspect,
                  const vk::ImageUsageFlags usage,
-                 const vk::MemoryPropertyFlags properties)
-    : width(width), height(height), device_(device) {
+                 const vk::MemoryPropertyFlags properties,
+                 const MemoryCategory category, const uint32_t layers)
+    : width(width), height(height), device_(allocator.device()),
+      allocator_(&allocator) {
   const auto image_info = vk::ImageCreateInfo()
                               .setImageType(vk::ImageType::e2D)
                               .setExtent(vk::Extent3D(width, height, 1))
                               .setMipLevels(1)
-                              .setArrayLayers(1)
+                              .setArrayLayers(layers)
                               .setFormat(format)
                               .setTiling(tiling)
                               .setInitialLayout(vk::ImageLayout::eUndefined)
@@ -72,23 +74,11 @@ VkImage::VkImage(const vk::Device device,
                               .setSharingMode(vk::SharingMode::eExclusive)
                               .setSamples(vk::SampleCountFlagBits::e1);
 
-  image = device.createImage(image_info);
-
-  const auto mem_requirements = device.getImageMemoryRequirements(image);
-
-  const auto alloc_info =
-      vk::MemoryAllocateInfo()
-          .setAllocationSize(mem_requirements.size)
-          .setMemoryTypeIndex(find_memory_type(
-              physical_device, mem_requirements.memoryTypeBits, properties));
-
-  memory = device.allocateMemory(alloc_info);
-
-  device.bindImageMemory(image, memory, 0);
-
-  image_view = VkImage::create_view(device, image, format, aspect);
-  sampler = VkImage::create_sampler(device, physical_device);
+  std::tie(image, allocation) =
+      allocator.create_image(image_info, properties, category);
 
+  image_view = VkImage::create_view(device_, image, format, aspect, layers);
+  sampler = VkImage::create_sampler(device_, allocator.physical_device());
 }
 
 }; // namespace mov
@@ -0,0 +1,403 @@
+#include <mov/VkUploader.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace mov {
+
+static constexpr vk::DeviceSize copy_alignment = 16;
+
+VkUploader::VkUploader(VkAllocator &allocator,
+                       const uint32_t transfer_family_index,
+                       const vk::Queue transfer_queue,
+                       const uint32_t graphics_family_index,
+                       const vk::Queue graphics_queue,
+                       const vk::DeviceSize ring_size)
+    : device_(allocator.device()), allocator_(&allocator),
+      transfer_family_(transfer_family_index),
+      graphics_family_(graphics_family_index), transfer_queue_(transfer_queue),
+      graphics_queue_(graphics_queue),
+      dedicated_(transfer_family_index != graphics_family_index),
+      ring_size_(ring_size) {
+  const auto create_pool = [this](const uint32_t family) {
+    return device_.createCommandPool(
+        {vk::CommandPoolCreateFlagBits::eResetCommandBuffer |
+             vk::CommandPoolCreateFlagBits::eTransient,
+         family});
+  };
+
+  const auto allocate = [this](const vk::CommandPool pool) {
+    return device_.allocateCommandBuffers(
+        vk::CommandBufferAllocateInfo()
+            .setLevel(vk::CommandBufferLevel::ePrimary)
+            .setCommandPool(pool)
+            .setCommandBufferCount(batch_count));
+  };
+
+  transfer_pool_ = create_pool(transfer_family_);
+  const auto command_buffers = allocate(transfer_pool_);
+
+  for (uint32_t i = 0; i < batch_count; i++) {
+    batches_[i].commands = command_buffers[i];
+    batches_[i].fence = device_.createFence({});
+  }
+
+  if (dedicated_) {
+    graphics_pool_ = create_pool(graphics_family_);
+    const auto acquire_buffers = allocate(graphics_pool_);
+
+    for (uint32_t i = 0; i < batch_count; i++) {
+      batches_[i].acquire = acquire_buffers[i];
+      batches_[i].semaphore = device_.createSemaphore({});
+    }
+  }
+
+  std::tie(ring_, ring_allocation_) =
+      allocator.create_buffer(ring_size_, vk::BufferUsageFlagBits::eTransferSrc,
+                              vk::MemoryPropertyFlagBits::eHostVisible |
+                                  vk::MemoryPropertyFlagBits::eHostCoherent,
+                              MemoryCategory::Staging);
+}
+
+auto VkUploader::begin_batch() -> Batch & {
+  auto &batch = batches_[current_];
+
+  if (recording_)
+    return batch;
+
+  retire(batch, true);
+
+  batch.commands.reset();
+  batch.commands.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+  batch.ticket = next_ticket_++;
+  batch.bytes = 0;
+  batch.copies = 0;
+  batch.started = std::chrono::steady_clock::now();
+
+  recording_ = true;
+
+  return batch;
+}
+
+auto VkUploader::reserve(const vk::DeviceSize size) -> vk::DeviceSize {
+  const auto oldest_pending = [this]() -> Batch * {
+    for (uint32_t i = 1; i <= batch_count; i++)
+      if (auto &batch = batches_[(current_ + i) % batch_count]; batch.pending)
+        return &batch;
+    return nullptr;
+  };
+
+  const auto place = [this, size] {
+    auto position = FreeList::align_up(head_, copy_alignment);
+
+    // Copies never straddle the end of the ring; skip to the next lap.
+    if (const auto offset = position % ring_size_; offset + size > ring_size_)
+      position += ring_size_ - offset;
+
+    return position;
+  };
+
+  auto position = place();
+
+  while (position + size - tail_ > ring_size_) {
+    if (const auto batch = oldest_pending()) {
+      retire(*batch, true);
+    } else if (recording_) {
+      flush();
+    } else {
+      head_ = tail_ = FreeList::align_up(head_, ring_size_);
+      position = head_;
+      break;
+    }
+
+    position = place();
+  }
+
+  head_ = position + size;
+
+  return position % ring_size_;
+}
+
+void VkUploader::upload(const vk::Buffer dst, const vk::DeviceSize dst_offset,
+                        const void *data, const vk::DeviceSize size) {
+  const auto source = static_cast<const std::byte *>(data);
+  const auto max_chunk = ring_size_ / 2;
+
+  for (vk::DeviceSize done = 0; done < size;) {
+    const auto chunk = std::min(size - done, max_chunk);
+    const auto offset = reserve(chunk);
+
+    auto &batch = begin_batch();
+
+    memcpy(static_cast<std::byte *>(ring_allocation_.mapped) + offset,
+           source + done, chunk);
+    batch.commands.copyBuffer(ring_, dst,
+                              vk::BufferCopy(offset, dst_offset + done, chunk));
+
+    batch.bytes += chunk;
+    batch.copies++;
+
+    done += chunk;
+  }
+
+  if (dedicated_ && size > 0) {
+    const vk::BufferMemoryBarrier release(
+        vk::AccessFlagBits::eTransferWrite, {}, transfer_family_,
+        graphics_family_, dst, dst_offset, size);
+
+    batches_[current_].commands.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, release,
+        nullptr);
+
+    buffer_acquires_.push_back(vk::BufferMemoryBarrier(release)
+                                   .setSrcAccessMask({})
+                                   .setDstAccessMask(
+                                       vk::AccessFlagBits::eMemoryRead));
+  }
+
+  poll();
+}
+
+void VkUploader::upload(const vk::Image dst, const vk::Extent2D extent,
+                        const vk::DeviceSize texel_size, const void *data,
+                        const vk::ImageLayout final_layout,
+                        const vk::ImageAspectFlags aspect) {
+  const auto source = static_cast<const std::byte *>(data);
+  const auto row_size = extent.width * texel_size;
+  const auto max_rows = static_cast<uint32_t>(ring_size_ / 2 / row_size);
+
+  if (max_rows == 0)
+    throw std::runtime_error("Image row does not fit in the staging ring!");
+
+  const vk::ImageSubresourceRange range(aspect, 0, 1, 0, 1);
+
+  begin_batch().commands.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTopOfPipe,
+      vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+      vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eTransferWrite,
+                             vk::ImageLayout::eUndefined,
+                             vk::ImageLayout::eTransferDstOptimal,
+                             VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                             dst, range));
+
+  for (uint32_t row = 0; row < extent.height;) {
+    const auto rows = std::min(extent.height - row, max_rows);
+    const auto chunk = rows * row_size;
+    const auto offset = reserve(chunk);
+
+    auto &batch = begin_batch();
+
+    memcpy(static_cast<std::byte *>(ring_allocation_.mapped) + offset,
+           source + row * row_size, chunk);
+    batch.commands.copyBufferToImage(
+        ring_, dst, vk::ImageLayout::eTransferDstOptimal,
+        vk::BufferImageCopy(offset, 0, 0, {aspect, 0, 0, 1},
+                            {0, static_cast<int32_t>(row), 0},
+                            {extent.width, rows, 1}));
+
+    batch.bytes += chunk;
+    batch.copies++;
+
+    row += rows;
+  }
+
+  auto &batch = batches_[current_];
+
+  if (dedicated_) {
+    const vk::ImageMemoryBarrier release(
+        vk::AccessFlagBits::eTransferWrite, {},
+        vk::ImageLayout::eTransferDstOptimal, final_layout, transfer_family_,
+        graphics_family_, dst, range);
+
+    batch.commands.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eBottomOfPipe,
+                                   {}, nullptr, nullptr, release);
+
+    image_acquires_.push_back(
+        vk::ImageMemoryBarrier(release).setSrcAccessMask({}).setDstAccessMask(
+            vk::AccessFlagBits::eMemoryRead));
+  } else {
+    batch.commands.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eAllCommands, {}, nullptr, nullptr,
+        vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                               vk::AccessFlagBits::eMemoryRead,
+                               vk::ImageLayout::eTransferDstOptimal,
+                               final_layout, VK_QUEUE_FAMILY_IGNORED,
+                               VK_QUEUE_FAMILY_IGNORED, dst, range));
+  }
+
+  poll();
+}
+
+void VkUploader::copy(const vk::Buffer src, const vk::Buffer dst,
+                      const vk::BufferCopy &region) {
+  begin_batch().copies++;
+
+  copies_.push_back({src, dst, region});
+}
+
+auto VkUploader::flush() -> uint64_t {
+  if (!recording_)
+    return next_ticket_ - 1;
+
+  auto &batch = batches_[current_];
+
+  const auto record_copies = [this](const vk::CommandBuffer commands) {
+    if (copies_.empty())
+      return;
+
+    commands.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eTransfer, {},
+        vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                          vk::AccessFlagBits::eTransferRead |
+                              vk::AccessFlagBits::eTransferWrite),
+        nullptr, nullptr);
+
+    for (const auto &[src, dst, region] : copies_)
+      commands.copyBuffer(src, dst, region);
+  };
+
+  // Submission order makes the copies visible to every later submit on the
+  // graphics queue, so consumers never have to wait on the upload themselves.
+  const auto make_visible = [](const vk::CommandBuffer commands) {
+    commands.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eAllCommands, {},
+        vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite,
+                          vk::AccessFlagBits::eMemoryRead),
+        nullptr, nullptr);
+  };
+
+  if (!dedicated_) {
+    record_copies(batch.commands);
+    make_visible(batch.commands);
+
+    batch.commands.end();
+
+    transfer_queue_.submit(vk::SubmitInfo().setCommandBuffers(batch.commands),
+                           batch.fence);
+  } else {
+    batch.commands.end();
+
+    transfer_queue_.submit(vk::SubmitInfo()
+                               .setCommandBuffers(batch.commands)
+                               .setSignalSemaphores(batch.semaphore));
+
+    batch.acquire.reset();
+    batch.acquire.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+    if (!buffer_acquires_.empty() || !image_acquires_.empty())
+      batch.acquire.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                    vk::PipelineStageFlagBits::eAllCommands,
+                                    {}, nullptr, buffer_acquires_,
+                                    image_acquires_);
+
+    record_copies(batch.acquire);
+
+    if (!copies_.empty())
+      make_visible(batch.acquire);
+
+    batch.acquire.end();
+
+    // The fence sits on the acquire submit, which cannot start before the
+    // transfer submit has signalled, so it covers both.
+    const vk::PipelineStageFlags wait_stage =
+        vk::PipelineStageFlagBits::eAllCommands;
+
+    graphics_queue_.submit(vk::SubmitInfo()
+                               .setWaitSemaphores(batch.semaphore)
+                               .setWaitDstStageMask(wait_stage)
+                               .setCommandBuffers(batch.acquire),
+                           batch.fence);
+  }
+
+  buffer_acquires_.clear();
+  image_acquires_.clear();
+  copies_.clear();
+
+  batch.ring_end = head_;
+  batch.pending = true;
+
+  recording_ = false;
+  current_ = (current_ + 1) % batch_count;
+
+  return batch.ticket;
+}
+
+void VkUploader::retire(Batch &batch, const bool block) {
+  if (!batch.pending)
+    return;
+
+  if (block) {
+    if (device_.waitForFences(batch.fence, true,
+                              std::numeric_limits<uint64_t>::max()) !=
+        vk::Result::eSuccess)
+      throw std::runtime_error("Failed to wait for upload batch!");
+  } else if (device_.getFenceStatus(batch.fence) != vk::Result::eSuccess) {
+    return;
+  }
+
+  device_.resetFences(batch.fence);
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto from = std::max(batch.started, busy_until_);
+
+  if (now > from)
+    stats_.busy += now - from;
+  busy_until_ = std::max(busy_until_, now);
+
+  stats_.bytes += batch.bytes;
+  stats_.copies += batch.copies;
+  stats_.batches++;
+
+  tail_ = std::max(tail_, batch.ring_end);
+  completed_ = std::max(completed_, batch.ticket);
+
+  batch.pending = false;
+}
+
+void VkUploader::poll() {
+  for (uint32_t i = 1; i <= batch_count; i++)
+    retire(batches_[(current_ + i) % batch_count], false);
+}
+
+void VkUploader::wait(const uint64_t ticket) {
+  if (ticket <= completed_)
+    return;
+
+  if (recording_ && batches_[current_].ticket <= ticket)
+    flush();
+
+  for (uint32_t i = 1; i <= batch_count && completed_ < ticket; i++)
+    retire(batches_[(current_ + i) % batch_count], true);
+}
+
+void VkUploader::wait_idle() {
+  flush();
+
+  for (auto &batch : batches_)
+    retire(batch, true);
+}
+
+void VkUploader::destroy() {
+  wait_idle();
+
+  for (const auto &batch : batches_) {
+    device_.destroyFence(batch.fence);
+
+    if (dedicated_)
+      device_.destroySemaphore(batch.semaphore);
+  }
+
+  if (dedicated_)
+    device_.destroyCommandPool(graphics_pool_);
+  device_.destroyCommandPool(transfer_pool_);
+  allocator_->destroy_buffer(ring_, ring_allocation_);
+}
+
+} // namespace mov
@@ -17,4 +17,60 @@ uint32_t find_memory_type(const vk::PhysicalDevice device,
   throw std::runtime_error("Failed to find suitable memory type!");
 }
 
+vk::Format find_supported_format(const vk::PhysicalDevice device,
+                                 const std::vector<vk::Format> &candidates,
+                                 const vk::ImageTiling tiling,
+                                 const vk::FormatFeatureFlags features) {
+  for (const auto &format : candidates) {
+    const auto props = device.getFormatProperties(format);
+
+    if (tiling == vk::ImageTiling::eLinear &&
+        (props.linearTilingFeatures & features) == features)
+      return format;
+    if (tiling == vk::ImageTiling::eOptimal &&
+        (props.optimalTilingFeatures & features) == features)
+      return format;
+  }
+
+  throw std::runtime_error("Failed to find supported format!");
+}
+
+QueueFamilies find_queue_families(const vk::PhysicalDevice device) {
+  const auto families = device.getQueueFamilyProperties();
+
+  const auto find = [&](const vk::QueueFlags required,
+                        const vk::QueueFlags excluded) {
+    for (uint32_t i = 0; i < families.size(); i++)
+      if (families[i].queueCount > 0 &&
+          (families[i].queueFlags & required) == required &&
+          !(families[i].queueFlags & excluded))
+        return i;
+
+    return ~0u;
+  };
+
+  QueueFamilies result{};
+  result.graphics = find(vk::QueueFlagBits::eGraphics, {});
+
+  if (result.graphics == ~0u)
+    throw std::runtime_error("Failed to find a graphics queue family!");
+
+  // Prefer a pure DMA family, then any non-graphics family that can copy.
+  result.transfer = find(vk::QueueFlagBits::eTransfer,
+                         vk::QueueFlagBits::eGraphics |
+                             vk::QueueFlagBits::eCompute);
+  if (result.transfer == ~0u)
+    result.transfer =
+        find(vk::QueueFlagBits::eTransfer, vk::QueueFlagBits::eGraphics);
+  if (result.transfer == ~0u)
+    result.transfer = result.graphics;
+
+  result.compute =
+      find(vk::QueueFlagBits::eCompute, vk::QueueFlagBits::eGraphics);
+  if (result.compute == ~0u)
+    result.compute = result.graphics;
+
+  return result;
+}
+
 }; // namespace mov
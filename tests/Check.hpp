@@ -0,0 +1,16 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+// Tests are plain programs: a failed CHECK is logged and counted, and the
+// test exits with the number of failures.
+inline int check_failures = 0;
+
+#define CHECK(condition)                                                      \
+  do {                                                                        \
+    if (!(condition)) {                                                       \
+      spdlog::error("{}:{}: check failed: {}", __FILE__, __LINE__,           \
+                    #condition);                                              \
+      check_failures++;                                                       \
+    }                                                                         \
+  } while (false)
@@ -0,0 +1,172 @@
+#include "Check.hpp"
+
+#include <mov/HeadlessContext.hpp>
+#include <mov/VkAllocator.hpp>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+struct Resource {
+  VkAllocation allocation;
+  vk::MemoryRequirements requirements;
+};
+
+// No two allocations in the same block may overlap.
+void check_disjoint(std::vector<Resource> resources) {
+  std::ranges::sort(resources, [](const Resource &a, const Resource &b) {
+    return std::tie(a.allocation.memory, a.allocation.offset) <
+           std::tie(b.allocation.memory, b.allocation.offset);
+  });
+
+  for (size_t i = 1; i < resources.size(); i++) {
+    const auto &previous = resources[i - 1].allocation;
+    const auto &current = resources[i].allocation;
+
+    if (previous.memory == current.memory)
+      CHECK(previous.offset + previous.size <= current.offset);
+  }
+}
+
+void check_aligned(const Resource &resource) {
+  CHECK(resource.allocation.offset % resource.requirements.alignment == 0);
+  CHECK(resource.allocation.size >= resource.requirements.size);
+}
+
+} // namespace
+
+int main() {
+  mov::HeadlessContext context;
+  const auto device = context.device();
+
+  spdlog::info("Device: {}",
+               context.physical_device().getProperties().deviceName.data());
+
+  // Small blocks, so the test spans several of them.
+  mov::VkAllocator allocator(device, context.physical_device(),
+                             1024 * 1024);
+
+  const auto usage = vk::BufferUsageFlagBits::eStorageBuffer |
+                     vk::BufferUsageFlagBits::eVertexBuffer;
+  const auto device_local = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+  std::vector<vk::Buffer> buffers;
+  std::vector<Resource> resources;
+
+  for (uint32_t i = 0; i < 96; i++) {
+    // Odd sizes, so the alignment padding matters.
+    const vk::DeviceSize size = 1000 + (i % 7) * 12'345;
+
+    const auto [buffer, allocation] =
+        allocator.create_buffer(size, usage, device_local);
+    buffers.push_back(buffer);
+    resources.push_back(
+        {allocation, device.getBufferMemoryRequirements(buffer)});
+
+    check_aligned(resources.back());
+  }
+
+  check_disjoint(resources);
+
+  const auto memory_type = resources.front().allocation.memory_type;
+
+  auto stats = allocator.stats(memory_type);
+  CHECK(stats.allocation_count == 96);
+  CHECK(stats.block_count > 1);
+  CHECK(stats.used <= stats.reserved);
+  CHECK(allocator.category_usage()[static_cast<uint32_t>(
+            mov::MemoryCategory::Other)] > 0);
+
+  // Every other buffer leaves holes between the survivors.
+  for (size_t i = 0; i < buffers.size(); i += 2)
+    allocator.destroy_buffer(buffers[i], resources[i].allocation);
+
+  const auto used_before = stats.used;
+  const auto block_count = stats.block_count;
+
+  stats = allocator.stats(memory_type);
+  CHECK(stats.allocation_count == 48);
+  CHECK(stats.used < used_before);
+  CHECK(stats.free_range_count > stats.block_count);
+  CHECK(stats.fragmentation() > 0.f);
+  CHECK(stats.fragmentation() < 1.f);
+
+  // The smallest size fits every hole, so no new block is needed.
+  std::vector<Resource> survivors;
+  for (size_t i = 1; i < buffers.size(); i += 2)
+    survivors.push_back(resources[i]);
+
+  for (size_t i = 0; i < buffers.size(); i += 2) {
+    const auto [buffer, allocation] =
+        allocator.create_buffer(1000, usage, device_local);
+    buffers[i] = buffer;
+    resources[i] = {allocation, device.getBufferMemoryRequirements(buffer)};
+
+    check_aligned(resources[i]);
+    survivors.push_back(resources[i]);
+  }
+
+  check_disjoint(survivors);
+  CHECK(allocator.stats(memory_type).block_count <= block_count);
+
+  // Optimally tiled images never share a block with buffers.
+  std::vector<vk::Image> images;
+  std::vector<Resource> image_resources;
+
+  for (uint32_t i = 0; i < 8; i++) {
+    const auto [image, allocation] = allocator.create_image(
+        vk::ImageCreateInfo()
+            .setImageType(vk::ImageType::e2D)
+            .setFormat(vk::Format::eR8G8B8A8Unorm)
+            .setExtent({64u << (i % 3), 64, 1})
+            .setMipLevels(1)
+            .setArrayLayers(1)
+            .setSamples(vk::SampleCountFlagBits::e1)
+            .setTiling(vk::ImageTiling::eOptimal)
+            .setUsage(vk::ImageUsageFlagBits::eSampled |
+                      vk::ImageUsageFlagBits::eTransferDst),
+        device_local, mov::MemoryCategory::Textures);
+
+    images.push_back(image);
+    image_resources.push_back(
+        {allocation, device.getImageMemoryRequirements(image)});
+
+    check_aligned(image_resources.back());
+    CHECK(!allocation.linear);
+  }
+
+  check_disjoint(image_resources);
+
+  for (const auto &image : image_resources)
+    for (const auto &buffer : survivors)
+      CHECK(image.allocation.memory != buffer.allocation.memory);
+
+  // Host visible allocations come back mapped at their own offset.
+  const auto [staging, staging_allocation] = allocator.create_buffer(
+      4096, vk::BufferUsageFlagBits::eTransferSrc,
+      vk::MemoryPropertyFlagBits::eHostVisible |
+          vk::MemoryPropertyFlagBits::eHostCoherent,
+      mov::MemoryCategory::Staging);
+  CHECK(staging_allocation.mapped != nullptr);
+
+  allocator.destroy_buffer(staging, staging_allocation);
+
+  for (size_t i = 0; i < images.size(); i++)
+    allocator.destroy_image(images[i], image_resources[i].allocation);
+  for (size_t i = 0; i < buffers.size(); i++)
+    allocator.destroy_buffer(buffers[i], resources[i].allocation);
+
+  stats = allocator.stats();
+  CHECK(stats.allocation_count == 0);
+  CHECK(stats.used == 0);
+  CHECK(stats.fragmentation() == 0.f);
+  for (const auto usage_bytes : allocator.category_usage())
+    CHECK(usage_bytes == 0);
+
+  allocator.destroy();
+  context.destroy();
+
+  return check_failures;
+}
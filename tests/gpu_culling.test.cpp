@@ -0,0 +1,218 @@
+#include "Check.hpp"
+
+#include <mov/GeometryPool.hpp>
+#include <mov/GpuCuller.hpp>
+#include <mov/HeadlessContext.hpp>
+#include <mov/Mesh.hpp>
+#include <mov/Meshlets.hpp>
+#include <mov/PipelineCache.hpp>
+#include <mov/ShaderRegistry.hpp>
+#include <mov/VkAllocator.hpp>
+#include <mov/VkUploader.hpp>
+#include <mov/shaders/Shaders.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// A closed UV sphere, so its meshlets get normal cones that can cull. The
+// triangles go out in tiles of 4 by 4 quads, so each meshlet covers a small
+// patch with a narrow cone rather than a band around the whole sphere.
+auto make_sphere(const uint32_t rings, const uint32_t segments) {
+  std::vector<mov::VertexAttributes> vertices;
+  std::vector<uint32_t> indices;
+
+  for (uint32_t ring = 0; ring <= rings; ring++) {
+    const auto theta = glm::pi<float>() * static_cast<float>(ring) /
+                       static_cast<float>(rings);
+
+    for (uint32_t segment = 0; segment <= segments; segment++) {
+      const auto phi = glm::two_pi<float>() * static_cast<float>(segment) /
+                       static_cast<float>(segments);
+      const glm::vec3 position(glm::sin(theta) * glm::cos(phi),
+                               glm::cos(theta),
+                               glm::sin(theta) * glm::sin(phi));
+
+      vertices.push_back({position, glm::vec3(1.f), position});
+    }
+  }
+
+  constexpr uint32_t tile = 4;
+
+  for (uint32_t tile_ring = 0; tile_ring < rings; tile_ring += tile)
+    for (uint32_t tile_segment = 0; tile_segment < segments;
+         tile_segment += tile)
+      for (auto ring = tile_ring; ring < std::min(tile_ring + tile, rings);
+           ring++)
+        for (auto segment = tile_segment;
+             segment < std::min(tile_segment + tile, segments); segment++) {
+          const auto a = ring * (segments + 1) + segment;
+          const auto b = a + segments + 1;
+
+          indices.insert(indices.end(), {a, a + 1, b, b, a + 1, b + 1});
+        }
+
+  return std::tuple{vertices, indices};
+}
+
+} // namespace
+
+int main() {
+  mov::HeadlessContext context;
+  const auto device = context.device();
+  const auto features = context.features();
+
+  spdlog::info("Device: {}",
+               context.physical_device().getProperties().deviceName.data());
+
+  mov::VkAllocator allocator(device, context.physical_device());
+  mov::VkUploader uploader(allocator, context.queue_family(), context.queue());
+  mov::GeometryPool geometry(mov::VkBufferProvider(allocator, uploader));
+
+  // Nothing is saved, so the cache file is never created.
+  mov::PipelineCache pipeline_cache(
+      device, context.physical_device(),
+      std::filesystem::temp_directory_path() / "mov.test.cache", false);
+  mov::ShaderRegistry shaders(mov::shaders::all);
+  const auto cull_shader = shaders.create_module(device, "cull.comp");
+
+  const std::vector<mov::VertexAttributes> quad_vertices = {
+      {{-0.5f, -0.5f, 0.f}}, {{0.5f, -0.5f, 0.f}},
+      {{0.5f, 0.5f, 0.f}}, {{-0.5f, 0.5f, 0.f}}};
+  const std::vector<uint32_t> quad_indices = {0, 1, 2, 2, 3, 0};
+  const mov::Mesh quad(geometry, quad_vertices, quad_indices,
+                       mov::VertexFormat::Float);
+
+  const auto [sphere_vertices, sphere_indices] = make_sphere(16, 32);
+  const mov::Mesh sphere(geometry, sphere_vertices, sphere_indices,
+                         mov::VertexFormat::Packed,
+                         mov::build_meshlets(sphere_indices, sphere_vertices));
+  CHECK(sphere.meshlets().size() > 1);
+
+  uploader.flush();
+  uploader.wait_idle();
+
+  // Objects scattered around the viewer, so every frame has some of them in
+  // view, some outside and some straddling a plane.
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(-40.f, 40.f);
+  std::uniform_real_distribution<float> scale(0.2f, 3.f);
+  std::uniform_real_distribution<float> angle(0.f, glm::two_pi<float>());
+
+  std::vector<glm::mat4> models(1'000);
+  for (auto &model : models) {
+    model = glm::translate(glm::mat4(1.f), {position(random), position(random),
+                                            position(random)});
+    model = glm::rotate(model, angle(random), glm::vec3(0.f, 1.f, 0.f));
+    model = glm::scale(model, glm::vec3(scale(random)));
+  }
+
+  const auto projection =
+      glm::perspective(glm::radians(90.f), 1.f, 0.1f, 50.f);
+
+  // With and without a count buffer, when the device has one.
+  std::vector<bool> compacting_modes = {false};
+  if (features.draw_indirect_count)
+    compacting_modes.push_back(true);
+
+  for (const bool compacting : compacting_modes) {
+    mov::GpuCuller culler(allocator, pipeline_cache, cull_shader, 2,
+                          compacting, features.multi_draw_indirect, true);
+
+    constexpr uint32_t frame_count = 8;
+
+    for (uint32_t frame = 0; frame < frame_count; frame++) {
+      // Two eyes turning around the origin.
+      const auto yaw = glm::two_pi<float>() * static_cast<float>(frame) /
+                       static_cast<float>(frame_count);
+      const glm::vec3 forward(glm::sin(yaw), 0.f, -glm::cos(yaw));
+      const glm::vec3 right(glm::cos(yaw), 0.f, glm::sin(yaw));
+
+      const glm::vec3 positions[] = {right * -0.03f, right * 0.03f};
+      const glm::mat4 view_projections[] = {
+          projection * glm::lookAt(positions[0], positions[0] + forward,
+                                   glm::vec3(0.f, 1.f, 0.f)),
+          projection * glm::lookAt(positions[1], positions[1] + forward,
+                                   glm::vec3(0.f, 1.f, 0.f))};
+
+      // Alternate single and stereo views.
+      culler.begin_frame(frame, view_projections, positions, 1 + frame % 2);
+
+      for (size_t i = 0; i < models.size(); i++)
+        culler.add(i % 2 == 0 ? quad : sphere, models[i]);
+
+      context.submit(
+          [&](const vk::CommandBuffer commands) { culler.dispatch(commands); });
+
+      CHECK(culler.verify());
+    }
+
+    const auto stats = culler.stats();
+    CHECK(stats.dispatches == frame_count);
+    CHECK(stats.verified_frames == frame_count);
+    CHECK(stats.mismatched_frames == 0);
+
+    spdlog::info("{}: {} objects culled in {} frames, {} mismatched",
+                 compacting ? "Compacted" : "Zeroed instance counts",
+                 stats.objects, stats.dispatches, stats.mismatched_frames);
+
+    // verify() only repeats the shader's cone test, so a cone pointing the
+    // wrong way would pass it. Seen from outside, the sphere has to keep
+    // every meshlet on the side facing the eye, whose outward normal is the
+    // direction of its center, and drop some on the far side.
+    const glm::vec3 eye(0.f, 0.f, 10.f);
+    const auto sphere_view =
+        projection *
+        glm::lookAt(eye, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+
+    culler.begin_frame(frame_count, &sphere_view, &eye, 1);
+    culler.add(sphere, glm::mat4(1.f));
+
+    context.submit(
+        [&](const vk::CommandBuffer commands) { culler.dispatch(commands); });
+
+    CHECK(culler.verify());
+
+    const auto kept = culler.kept_objects();
+    const auto meshlets = sphere.meshlets();
+    uint32_t dropped = 0;
+
+    for (uint32_t i = 0; i < meshlets.size(); i++) {
+      const auto center = meshlets[i].sphere.center;
+      const auto facing =
+          glm::dot(center - eye, glm::normalize(center)) < 0.f;
+      const auto was_kept = std::ranges::binary_search(kept, i);
+
+      if (facing)
+        CHECK(was_kept);
+      else if (!was_kept)
+        dropped++;
+    }
+
+    CHECK(dropped > 0);
+
+    spdlog::info("Sphere from outside: {} of {} meshlets kept", kept.size(),
+                 meshlets.size());
+
+    culler.destroy();
+  }
+
+  quad.destroy();
+  sphere.destroy();
+  device.destroyShaderModule(cull_shader);
+  pipeline_cache.destroy();
+  geometry.destroy();
+  uploader.destroy();
+  allocator.destroy();
+  context.destroy();
+
+  return check_failures;
+}